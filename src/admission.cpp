@@ -0,0 +1,202 @@
+#include "admission.h"
+#include "config.h"
+#include "logger.h"
+#include "events.h"
+#include "snapshot.h"
+#include <atomic>
+
+// ===== SEAUX À JETONS =====
+// Un seul horodatage par source (forme GCRA) : l'instant où son seau sera de
+// nouveau plein. Chaque jeton pris le repousse d'un intervalle ; la demande
+// est refusée s'il dépasse maintenant de plus d'une rafale.
+struct SourceSlot {
+  uint32_t key;
+  uint32_t full;
+};
+
+static bool takeToken(uint32_t& full, uint32_t now, uint32_t interval, uint8_t burst) {
+  if ((int32_t)(full - now) < 0) full = now;  // Seau plein
+  if (full - now + interval > (uint32_t)burst * interval) return false;
+  full += interval;
+  return true;
+}
+
+// Source inconnue : prend la place de la plus reposée de la table
+static uint32_t& bucketFor(SourceSlot* slots, uint8_t count, uint32_t key, uint32_t now) {
+  SourceSlot* idlest = &slots[0];
+  for (uint8_t i = 0; i < count; i++) {
+    if (slots[i].key == key) return slots[i].full;
+    if ((int32_t)(slots[i].full - idlest->full) < 0) idlest = &slots[i];
+  }
+  idlest->key = key;
+  idlest->full = now;
+  return idlest->full;
+}
+
+// Compteurs lus depuis loop() et le serveur web
+static std::atomic<uint32_t> httpRateLimited{0};
+static std::atomic<uint32_t> httpBusy{0};
+static std::atomic<uint32_t> httpTooLarge{0};
+static std::atomic<uint32_t> mqttRateLimited{0};
+static std::atomic<uint32_t> keypadRateLimited{0};
+static std::atomic<uint32_t> keypadLocked{0};
+static std::atomic<uint32_t> keypadLockouts{0};
+
+// ===== HTTP =====
+// Tâche du serveur web uniquement
+static SourceSlot httpSlots[ADMIT_HTTP_SOURCES];
+static std::atomic<uint8_t> httpInflight{0};
+
+// Premier gestionnaire enregistré : consulté pour chaque requête, en-têtes
+// lus et avant les routes. Il ne prend la requête que pour la refuser ; le
+// corps d'une requête refusée n'est jamais mis en mémoire.
+class AdmissionHandler : public AsyncWebHandler {
+ public:
+  bool canHandle(AsyncWebServerRequest* request) override {
+    uint16_t status = admit(request);
+    if (status == 0) return false;
+    // Libéré avec la requête
+    request->_tempObject = malloc(sizeof(uint16_t));
+    if (request->_tempObject) *(uint16_t*)request->_tempObject = status;
+    return true;
+  }
+
+  void handleRequest(AsyncWebServerRequest* request) override {
+    uint16_t status = request->_tempObject ? *(uint16_t*)request->_tempObject : 503;
+    const char* body = status == 413 ? "{\"error\":\"Requête trop volumineuse\"}"
+                     : status == 429 ? "{\"error\":\"Trop de requêtes\"}"
+                                     : "{\"error\":\"Serveur occupé\"}";
+    AsyncWebServerResponse* response = request->beginResponse(status, "application/json", body);
+    if (status != 413) response->addHeader("Retry-After", "1");
+    request->send(response);
+  }
+
+  bool isRequestHandlerTrivial() override { return true; }
+
+ private:
+  // 0 si admise, sinon le statut HTTP du refus
+  static uint16_t admit(AsyncWebServerRequest* request) {
+    size_t maxBody = request->url() == ADMIT_HTTP_SNAPSHOT_URI ? SNAPSHOT_MAX_SIZE : ADMIT_HTTP_MAX_BODY;
+    if (request->url().startsWith("/api/") && request->contentLength() > maxBody) {
+      httpTooLarge++;
+      return 413;
+    }
+
+    uint32_t ip = request->client() ? (uint32_t)request->client()->remoteIP() : 0;
+    uint32_t now = millis();
+    if (!takeToken(bucketFor(httpSlots, ADMIT_HTTP_SOURCES, ip, now), now,
+                   ADMIT_HTTP_INTERVAL_MS, ADMIT_HTTP_BURST)) {
+      httpRateLimited++;
+      return 429;
+    }
+
+    if (httpInflight >= ADMIT_HTTP_MAX_INFLIGHT) {
+      httpBusy++;
+      return 503;
+    }
+    httpInflight++;
+    request->onDisconnect([]() { httpInflight--; });
+    return 0;
+  }
+};
+
+static AdmissionHandler admissionHandler;
+
+void admissionAttach(AsyncWebServer& server) {
+  server.addHandler(&admissionHandler);
+}
+
+// ===== MQTT =====
+static SourceSlot mqttSlots[ADMIT_MQTT_SOURCES];
+
+bool admitMqtt(const char* topic) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (const char* c = topic; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619u;
+
+  uint32_t now = millis();
+  if (takeToken(bucketFor(mqttSlots, ADMIT_MQTT_SOURCES, hash, now), now,
+                ADMIT_MQTT_INTERVAL_MS, ADMIT_MQTT_BURST)) {
+    return true;
+  }
+  if (mqttRateLimited++ % 100 == 0) LOG_W("⚠ MQTT rate limited on %s", topic);
+  return false;
+}
+
+// ===== CLAVIER =====
+struct KeypadGuard {
+  uint32_t full;
+  uint32_t lockedUntil;
+  uint8_t denials;     // Refus consécutifs depuis le dernier verrouillage
+  uint8_t lockouts;    // Verrouillages depuis le dernier accès accordé
+  bool locked;
+};
+
+static KeypadGuard keypadGuards[MAX_READERS];
+
+bool admitKeypad(uint8_t reader) {
+  if (reader >= MAX_READERS) return false;
+  KeypadGuard& guard = keypadGuards[reader];
+  uint32_t now = millis();
+
+  if (guard.locked) {
+    if ((int32_t)(guard.lockedUntil - now) > 0) {
+      keypadLocked++;
+      return false;
+    }
+    guard.locked = false;
+  }
+
+  if (!takeToken(guard.full, now, ADMIT_KEYPAD_INTERVAL_MS, ADMIT_KEYPAD_BURST)) {
+    keypadRateLimited++;
+    return false;
+  }
+  return true;
+}
+
+void admissionKeypadResult(uint8_t reader, bool granted) {
+  if (reader >= MAX_READERS) return;
+  KeypadGuard& guard = keypadGuards[reader];
+
+  if (granted) {
+    guard.denials = 0;
+    guard.lockouts = 0;
+    return;
+  }
+
+  if (++guard.denials < ADMIT_LOCKOUT_DENIALS) return;
+
+  uint32_t duration = ADMIT_LOCKOUT_MS << (guard.lockouts < 5 ? guard.lockouts : 5);
+  if (duration > ADMIT_LOCKOUT_MAX_MS) duration = ADMIT_LOCKOUT_MAX_MS;
+  guard.denials = 0;
+  if (guard.lockouts < 255) guard.lockouts++;
+  guard.locked = true;
+  guard.lockedUntil = millis() + duration;
+  keypadLockouts++;
+
+  LOG_W("🔒 Keypad locked on reader %u for %lu s (%u denials)",
+        reader, duration / 1000, ADMIT_LOCKOUT_DENIALS);
+  char payload[64];
+  snprintf(payload, sizeof(payload), "{\"reader\":%u,\"seconds\":%lu}", reader, duration / 1000);
+  publishEvent("lockout", payload);
+}
+
+void admissionToJson(JsonObject out) {
+  JsonObject http = out["http"].to<JsonObject>();
+  http["inflight"] = httpInflight.load();
+  http["rateLimited"] = httpRateLimited.load();
+  http["busy"] = httpBusy.load();
+  http["tooLarge"] = httpTooLarge.load();
+
+  out["mqtt"]["rateLimited"] = mqttRateLimited.load();
+
+  JsonObject keypad = out["keypad"].to<JsonObject>();
+  keypad["rateLimited"] = keypadRateLimited.load();
+  keypad["whileLocked"] = keypadLocked.load();
+  keypad["lockouts"] = keypadLockouts.load();
+  JsonArray locked = keypad["lockedReaders"].to<JsonArray>();
+  uint32_t now = millis();
+  for (uint8_t reader = 0; reader < MAX_READERS; reader++) {
+    const KeypadGuard& guard = keypadGuards[reader];
+    if (guard.locked && (int32_t)(guard.lockedUntil - now) > 0) locked.add(reader);
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+
+// ===== CONTRÔLE D'ADMISSION =====
+// Une intégration qui boucle ou une attaque par force brute ne doit affamer
+// ni loop() ni le tas : chaque source (adresse IP, topic MQTT, lecteur) a son
+// seau à jetons, les requêtes HTTP simultanées et la taille des corps sont
+// plafonnées, et un clavier est verrouillé après une série de refus.
+// Les rejets sont comptés et exposés dans /api/status ("admission").
+
+// HTTP : par adresse IP, plus un plafond global
+#define ADMIT_HTTP_SOURCES       16
+#define ADMIT_HTTP_INTERVAL_MS   100     // 10 requêtes/s en régime établi
+#define ADMIT_HTTP_BURST         30
+#define ADMIT_HTTP_MAX_INFLIGHT  6       // Requêtes en cours, toutes IP
+#define ADMIT_HTTP_MAX_BODY      32768   // Corps des requêtes /api/*
+#define ADMIT_HTTP_SNAPSHOT_URI  "/api/snapshot/restore"  // Plafond SNAPSHOT_MAX_SIZE
+
+// MQTT : par topic
+#define ADMIT_MQTT_SOURCES       16
+#define ADMIT_MQTT_INTERVAL_MS   100
+#define ADMIT_MQTT_BURST         20
+
+// Clavier : par lecteur, puis verrouillage après des refus consécutifs
+#define ADMIT_KEYPAD_INTERVAL_MS 5000    // 1 essai / 5 s après la rafale
+#define ADMIT_KEYPAD_BURST       3
+#define ADMIT_LOCKOUT_DENIALS    5
+#define ADMIT_LOCKOUT_MS         30000   // Doublé à chaque récidive...
+#define ADMIT_LOCKOUT_MAX_MS     900000  // ... jusqu'à 15 minutes
+
+void admissionAttach(AsyncWebServer& server);  // Avant toute autre route
+bool admitMqtt(const char* topic);
+bool admitKeypad(uint8_t reader);
+void admissionKeypadResult(uint8_t reader, bool granted);
+void admissionToJson(JsonObject out);
+
+#endif
@@ -0,0 +1,278 @@
+#include "auth.h"
+#include "config.h"
+#include "logger.h"
+#include <ElegantOTA.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <mbedtls/sha256.h>
+#include <time.h>
+
+extern Config config;
+extern Preferences preferences;
+
+#define HMAC_BLOCK  64
+#define HMAC_SIZE   32
+
+// ===== HMAC-SHA256 =====
+// Blocs clé ^ ipad / clé ^ opad précalculés ; contextes SHA sur la pile,
+// mbedtls utilise l'accélérateur SHA de l'ESP32 quand il est libre.
+struct HmacKey {
+  uint8_t inner[HMAC_BLOCK];
+  uint8_t outer[HMAC_BLOCK];
+};
+
+static void hmacSetKey(HmacKey& key, const uint8_t* secret, size_t len) {
+  uint8_t block[HMAC_BLOCK] = {0};
+  if (len > HMAC_BLOCK) {
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    mbedtls_sha256_update(&sha, secret, len);
+    mbedtls_sha256_finish(&sha, block);
+    mbedtls_sha256_free(&sha);
+  } else {
+    memcpy(block, secret, len);
+  }
+  for (uint8_t i = 0; i < HMAC_BLOCK; i++) {
+    key.inner[i] = block[i] ^ 0x36;
+    key.outer[i] = block[i] ^ 0x5c;
+  }
+}
+
+static void hmac(const HmacKey& key, const uint8_t* data, size_t len, uint8_t out[HMAC_SIZE]) {
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  mbedtls_sha256_update(&sha, key.inner, HMAC_BLOCK);
+  mbedtls_sha256_update(&sha, data, len);
+  mbedtls_sha256_finish(&sha, out);
+
+  mbedtls_sha256_starts(&sha, 0);
+  mbedtls_sha256_update(&sha, key.outer, HMAC_BLOCK);
+  mbedtls_sha256_update(&sha, out, HMAC_SIZE);
+  mbedtls_sha256_finish(&sha, out);
+  mbedtls_sha256_free(&sha);
+}
+
+// Durée indépendante de la position de la première différence
+static bool equalConstantTime(const uint8_t* a, const uint8_t* b, size_t len) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < len; i++) diff |= a[i] ^ b[i];
+  return diff == 0;
+}
+
+static void toHex(const uint8_t* data, size_t len, char* out) {
+  static const char digits[] = "0123456789abcdef";
+  for (size_t i = 0; i < len; i++) {
+    out[i * 2] = digits[data[i] >> 4];
+    out[i * 2 + 1] = digits[data[i] & 0x0f];
+  }
+  out[len * 2] = '\0';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static bool fromHex(const char* text, uint8_t* out, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    int high = hexValue(text[i * 2]);
+    int low = high < 0 ? -1 : hexValue(text[i * 2 + 1]);
+    if (low < 0) return false;
+    out[i] = (high << 4) | low;
+  }
+  return true;
+}
+
+// ===== CLÉS =====
+static HmacKey sessionKey;   // Aléatoire, renouvelée à chaque changement de mot de passe
+static HmacKey messageKey;   // Mot de passe admin (signatures MQTT)
+
+static uint32_t uptimeSeconds() {
+  return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+void authPasswordChanged() {
+  uint8_t secret[HMAC_SIZE];
+  esp_fill_random(secret, sizeof(secret));
+  hmacSetKey(sessionKey, secret, sizeof(secret));
+  hmacSetKey(messageKey, (const uint8_t*)config.adminPassword, strlen(config.adminPassword));
+  ElegantOTA.setAuth("admin", config.adminPassword);  // Page /update
+}
+
+static uint32_t lastMessageTs = 0;
+static uint32_t persistedTs = 0;
+
+void authBegin() {
+  authPasswordChanged();
+  // Plancher survivant au redémarrage : sans SNTP, seul rempart contre le
+  // rejeu d'un message capturé avant la coupure
+  persistedTs = preferences.getUInt("mqttTs", 0);
+  lastMessageTs = persistedTs;
+}
+
+// ===== SESSIONS HTTP =====
+// Jeton : hex(expiration (s depuis le démarrage) | aléa) + hex(MAC de ces 8 octets)
+#define TOKEN_HEADER  8
+
+// Échecs consécutifs par adresse IP (tâche du serveur web uniquement)
+struct LoginSource {
+  uint32_t ip;
+  uint32_t blockedUntil;
+  uint8_t failures;   // Saturé à 255 : le délai ne repart jamais de zéro
+};
+
+static LoginSource loginSources[AUTH_LOGIN_SOURCES];
+
+// IP inconnue : prend la place sans échec, sinon la moins récemment bloquée
+static LoginSource& loginSourceFor(uint32_t ip) {
+  LoginSource* oldest = &loginSources[0];
+  for (uint8_t i = 0; i < AUTH_LOGIN_SOURCES; i++) {
+    LoginSource& source = loginSources[i];
+    if (source.failures > 0 && source.ip == ip) return source;
+    if (oldest->failures == 0) continue;
+    if (source.failures == 0 || (int32_t)(source.blockedUntil - oldest->blockedUntil) < 0) {
+      oldest = &source;
+    }
+  }
+  oldest->ip = ip;
+  oldest->failures = 0;
+  oldest->blockedUntil = millis();
+  return *oldest;
+}
+
+bool authLogin(const char* password, uint32_t ip, char* token, size_t size, uint32_t& retryMs) {
+  uint32_t now = millis();
+  LoginSource& source = loginSourceFor(ip);
+  if ((int32_t)(source.blockedUntil - now) > 0) {
+    retryMs = source.blockedUntil - now;
+    return false;
+  }
+
+  if (!password || size < AUTH_TOKEN_LEN + 1) return false;
+
+  // Comparaison en temps constant sur toute la taille du champ (copies
+  // complétées de zéros : la longueur ne transparaît pas non plus)
+  char candidate[sizeof(config.adminPassword)] = {0};
+  char stored[sizeof(config.adminPassword)] = {0};
+  strlcpy(candidate, password, sizeof(candidate));
+  strlcpy(stored, config.adminPassword, sizeof(stored));
+  bool valid = strlen(password) < sizeof(candidate) &&
+               equalConstantTime((const uint8_t*)candidate, (const uint8_t*)stored, sizeof(stored));
+
+  if (!valid) {
+    uint32_t backoff = AUTH_LOGIN_BACKOFF_MS << (source.failures < 6 ? source.failures : 6);
+    if (backoff > 60000) backoff = 60000;
+    if (source.failures < 255) source.failures++;
+    source.blockedUntil = now + backoff;
+    retryMs = backoff;
+    LOG_W("🔒 Login failed from %s (%u consecutive)", IPAddress(ip).toString().c_str(), source.failures);
+    return false;
+  }
+  source.failures = 0;
+
+  uint8_t data[TOKEN_HEADER + HMAC_SIZE];
+  uint32_t expires = uptimeSeconds() + AUTH_SESSION_TTL_S;
+  memcpy(data, &expires, 4);
+  esp_fill_random(data + 4, 4);
+  hmac(sessionKey, data, TOKEN_HEADER, data + TOKEN_HEADER);
+
+  toHex(data, sizeof(data), token);
+  LOG_I("🔑 Session opened");
+  return true;
+}
+
+bool authCheckToken(const char* token) {
+  if (!token || strlen(token) != AUTH_TOKEN_LEN) return false;
+
+  uint8_t data[TOKEN_HEADER + HMAC_SIZE];
+  if (!fromHex(token, data, sizeof(data))) return false;
+
+  uint8_t expected[HMAC_SIZE];
+  hmac(sessionKey, data, TOKEN_HEADER, expected);
+  if (!equalConstantTime(expected, data + TOKEN_HEADER, HMAC_SIZE)) return false;
+
+  uint32_t expires;
+  memcpy(&expires, data, 4);
+  return (int32_t)(expires - uptimeSeconds()) > 0;
+}
+
+// Deuxième gestionnaire (après l'admission) : prend les requêtes /api/*
+// sans jeton valide pour répondre 401, laisse passer les autres.
+class AuthHandler : public AsyncWebHandler {
+ public:
+  bool canHandle(AsyncWebServerRequest* request) override {
+    const String& url = request->url();
+    if (!url.startsWith("/api/") || url == "/api/login") return false;
+
+    AsyncWebHeader* header = request->getHeader("Authorization");
+    const char* value = header ? header->value().c_str() : "";
+    if (strncmp(value, "Bearer ", 7) == 0 && authCheckToken(value + 7)) return false;
+    return true;
+  }
+
+  void handleRequest(AsyncWebServerRequest* request) override {
+    request->send(401, "application/json", "{\"error\":\"Authentification requise\"}");
+  }
+
+  bool isRequestHandlerTrivial() override { return true; }
+};
+
+static AuthHandler authHandler;
+
+void authAttach(AsyncWebServer& server) {
+  server.addHandler(&authHandler);
+}
+
+// ===== MESSAGES MQTT SIGNÉS =====
+// Le plancher écrit en flash devance le dernier "ts" accepté de
+// AUTH_TS_RESERVE_S : une écriture par minute d'activité au plus, et tout
+// message accepté avant un redémarrage reste en dessous du plancher relu.
+static bool reserveTs(uint32_t ts) {
+  if (ts <= persistedTs) return true;
+  uint32_t floor = ts + AUTH_TS_RESERVE_S;
+  if (preferences.putUInt("mqttTs", floor) == 0) {
+    LOG_E("✗ MQTT: replay floor not saved, message rejected");
+    return false;
+  }
+  persistedTs = floor;
+  return true;
+}
+
+bool authVerifyMessage(char* message, unsigned int& length) {
+  // "<json>\n<64 hex>"
+  if (length < HMAC_SIZE * 2 + 1 || message[length - HMAC_SIZE * 2 - 1] != '\n') {
+    LOG_W("🔒 MQTT: unsigned management message rejected");
+    return false;
+  }
+  unsigned int jsonLength = length - HMAC_SIZE * 2 - 1;
+
+  uint8_t signature[HMAC_SIZE];
+  uint8_t expected[HMAC_SIZE];
+  hmac(messageKey, (const uint8_t*)message, jsonLength, expected);
+  if (!fromHex(message + jsonLength + 1, signature, HMAC_SIZE) ||
+      !equalConstantTime(expected, signature, HMAC_SIZE)) {
+    LOG_W("🔒 MQTT: bad signature");
+    return false;
+  }
+
+  // Le JSON est authentique : simple recherche de "ts" sans analyse complète
+  message[jsonLength] = '\0';
+  const char* field = strstr(message, "\"ts\":");
+  uint32_t ts = field ? strtoul(field + 5, nullptr, 10) : 0;
+  time_t now = time(nullptr);
+  bool clockSet = now >= 1700000000;
+  if (ts <= lastMessageTs ||
+      (clockSet && (ts + AUTH_MQTT_WINDOW_S < (uint32_t)now || ts > (uint32_t)now + AUTH_MQTT_WINDOW_S))) {
+    LOG_W("🔒 MQTT: stale or replayed message (ts=%lu)", ts);
+    return false;
+  }
+  if (!reserveTs(ts)) return false;
+
+  lastMessageTs = ts;
+  length = jsonLength;
+  return true;
+}
@@ -0,0 +1,39 @@
+#ifndef AUTH_H
+#define AUTH_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// ===== AUTHENTIFICATION =====
+// HTTP : POST /api/login vérifie le mot de passe admin une seule fois et
+// délivre un jeton de session signé (HMAC-SHA256, clé aléatoire tirée au
+// démarrage). Chaque requête /api/* présente ensuite
+// "Authorization: Bearer <jeton>" : vérification sans allocation ni accès
+// flash, comparaison en temps constant. Changer le mot de passe (ou
+// redémarrer) révoque toutes les sessions. La page OTA (/update) demande
+// l'utilisateur "admin" et ce même mot de passe.
+//
+// MQTT : les topics de gestion attendent "<json>\n<signature>", signature =
+// HMAC-SHA256 du JSON en hexadécimal, clé = mot de passe admin. Le JSON
+// porte "ts" (secondes Unix), strictement croissant, y compris après un
+// redémarrage (plancher en flash) ; à ±5 min de l'heure locale quand SNTP a
+// répondu (rejeu impossible).
+#define AUTH_SESSION_TTL_S    28800   // 8 heures
+#define AUTH_TOKEN_LEN        80      // Hexadécimal : expiration + aléa (8 o) + MAC (32 o)
+#define AUTH_MQTT_WINDOW_S    300
+#define AUTH_TS_RESERVE_S     60      // Avance du plancher "ts" écrit en flash
+#define AUTH_LOGIN_BACKOFF_MS 1000    // Doublé à chaque échec, 1 min au plus...
+#define AUTH_LOGIN_SOURCES    16      // ... par adresse IP (un client ne bloque pas les autres)
+
+void authBegin();
+void authAttach(AsyncWebServer& server);  // Après admissionAttach, avant les routes
+void authPasswordChanged();               // Sessions révoquées, clé MQTT recalculée
+
+// Faux si mot de passe faux ou essai trop rapproché depuis `ip` (`retryMs` renseigné)
+bool authLogin(const char* password, uint32_t ip, char* token, size_t size, uint32_t& retryMs);
+bool authCheckToken(const char* token);
+
+// Vérifie et retire la signature ; faux si absente, fausse ou rejouée
+bool authVerifyMessage(char* message, unsigned int& length);
+
+#endif
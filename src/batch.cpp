@@ -0,0 +1,198 @@
+#include "batch.h"
+#include "config.h"
+#include "logger.h"
+#include "schedule.h"
+#include "groups.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "code_sync.h"
+
+extern AccessCode* accessCodes;
+extern uint16_t* accessCodeGroups;
+extern int accessCodeCount;
+
+extern bool insertAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule,
+                             uint16_t groups);
+extern void eraseAccessCodeAt(int index);
+extern void loadAccessCodes();
+extern bool commitAccessCodes(uint32_t version);
+extern size_t saveConfig(int* changedFields);
+extern void revertConfig();
+extern bool applyConfigPatch(JsonVariant doc, const char*& error);
+extern bool publishMQTT(const char* topic, const char* payload);
+
+struct BatchState {
+  bool codesDirty;
+  bool configDirty;
+  uint8_t relayCount;
+  JsonVariant relayOps[BATCH_MAX_OPS];
+};
+
+static int findCode(JsonVariant op) {
+  uint32_t code = op["code"] | 0;
+  uint8_t type = op["type"] | 0;
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == code && accessCodes[i].type == type) return i;
+  }
+  return -1;
+}
+
+// Exécution d'une opération en RAM ; retourne false avec `error` renseigné
+static bool runOperation(JsonVariant op, BatchState& state, const char*& error) {
+  const char* name = op["op"] | "";
+
+  if (strcmp(name, "codes.add") == 0) {
+    if (!validateCodeEntry(op, error)) return false;
+    if (!insertAccessCode(op["code"], op["type"], op["name"], op["schedule"] | 0,
+                          op["groups"] | GROUP_DEFAULT_MASK)) {
+      error = "Code existant ou table pleine";
+      return false;
+    }
+    state.codesDirty = true;
+    return true;
+  }
+
+  if (strcmp(name, "codes.remove") == 0 || strcmp(name, "codes.delete") == 0) {
+    int index = op["index"].is<int>() ? op["index"].as<int>() : findCode(op);
+    if (index < 0 || index >= accessCodeCount) {
+      error = "Code introuvable";
+      return false;
+    }
+    eraseAccessCodeAt(index);
+    state.codesDirty = true;
+    return true;
+  }
+
+  if (strcmp(name, "codes.schedule") == 0 || strcmp(name, "codes.groups") == 0) {
+    int index = findCode(op);
+    if (index < 0) {
+      error = "Code introuvable";
+      return false;
+    }
+    if (strcmp(name, "codes.schedule") == 0) {
+      uint8_t schedule = op["schedule"] | 0;
+      if (schedule > MAX_SCHEDULES || (schedule != 0 && !schedules[schedule].used)) {
+        error = "Plage horaire inconnue";
+        return false;
+      }
+      accessCodes[index].schedule = schedule;
+    } else {
+      if (!op["groups"].is<uint16_t>()) {
+        error = "groups manquant";
+        return false;
+      }
+      accessCodeGroups[index] = op["groups"];
+    }
+    state.codesDirty = true;
+    return true;
+  }
+
+  if (strcmp(name, "config") == 0) {
+    if (!applyConfigPatch(op, error)) return false;
+    state.configDirty = true;
+    return true;
+  }
+
+  if (strcmp(name, "relay") == 0) {
+    int door = op["door"] | 0;
+    const char* action = op["action"] | "";
+    if (door < 0 || door >= doorCount) {
+      error = "Porte inconnue";
+      return false;
+    }
+    if (!doorActionValid(action)) {
+      error = "Action invalide";
+      return false;
+    }
+    state.relayOps[state.relayCount++] = op;  // Exécutée après l'enregistrement
+    return true;
+  }
+
+  error = "Opération inconnue";
+  return false;
+}
+
+// Format attendu :
+// {"atomic":true,"ops":[{"op":"codes.add","code":1234,"type":0,"name":"Admin"},
+//                       {"op":"config","relayDuration":8000},
+//                       {"op":"relay","action":"open","door":0}]}
+// atomic=true (défaut) : au premier échec, tout est annulé et rien n'est écrit.
+bool runBatch(JsonVariant request, JsonObject response) {
+  JsonArray ops = request["ops"];
+  bool atomic = request["atomic"] | true;
+
+  JsonArray results = response["results"].to<JsonArray>();
+  if (ops.isNull() || ops.size() == 0 || ops.size() > BATCH_MAX_OPS) {
+    response["ok"] = false;
+    response["error"] = "ops manquant ou trop long (1-100)";
+    return false;
+  }
+
+  static BatchState state;  // Trop gros pour la pile (tableau de JsonVariant)
+  state.codesDirty = false;
+  state.configDirty = false;
+  state.relayCount = 0;
+
+  int failed = 0;
+  for (JsonVariant op : ops) {
+    JsonObject result = results.add<JsonObject>();
+    if (atomic && failed > 0) {
+      result["ok"] = false;
+      result["error"] = "Non exécutée";
+      continue;
+    }
+
+    const char* error = nullptr;
+    bool ok = runOperation(op, state, error);
+    result["ok"] = ok;
+    if (!ok) {
+      result["error"] = error;
+      failed++;
+    }
+  }
+
+  // Annulation : la flash contient encore l'état d'avant le lot
+  if (atomic && failed > 0) {
+    if (state.codesDirty) loadAccessCodes();
+    if (state.configDirty) revertConfig();
+    response["ok"] = false;
+    response["committed"] = false;
+    LOG_W("⚠ Batch rejected: %d failed operation(s), rolled back", failed);
+    return false;
+  }
+
+  // Une écriture par zone modifiée, la table des codes d'abord : si elle
+  // échoue, rien n'a encore été écrit et tout le lot est annulé
+  if (state.codesDirty && !commitAccessCodes(codeTableVersion + 1)) {
+    loadAccessCodes();
+    if (state.configDirty) revertConfig();
+    response["ok"] = false;
+    response["committed"] = false;
+    response["flashError"] = true;
+    response["error"] = "Écriture flash impossible";
+    LOG_E("✗ Batch not saved, rolled back");
+    return false;
+  }
+  int configChanged = 0;
+  if (state.configDirty) saveConfig(&configChanged);
+
+  for (uint8_t i = 0; i < state.relayCount; i++) {
+    submitDoorAction(state.relayOps[i]["door"] | 0, state.relayOps[i]["action"] | "", SOURCE_REMOTE);
+  }
+
+  response["ok"] = failed == 0;
+  response["committed"] = true;
+  response["failed"] = failed;
+  response["configChanged"] = configChanged;
+  response["codeCount"] = accessCodeCount;
+  response["version"] = codeTableVersion;
+
+  LOG_I("✓ Batch executed: %u operation(s), %d failed", ops.size(), failed);
+
+  if (state.codesDirty) {
+    char payload[96];
+    snprintf(payload, sizeof(payload), "{\"action\":\"batch\",\"total\":%d}", accessCodeCount);
+    publishMQTT("codes", payload);
+  }
+  return failed == 0;
+}
@@ -0,0 +1,18 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== OPÉRATIONS PAR LOT =====
+// Une liste ordonnée d'opérations exécutée comme une transaction : les
+// modifications sont faites en RAM, puis écrites en flash une seule fois à
+// la fin (un commit pour la table des codes, un pour la configuration).
+// Les commandes de relais ne sont exécutées qu'après l'enregistrement.
+// Depuis loop() seulement (MQTT, ou /api/batch via schedulerCall()) : les
+// lots s'exécutent l'un après l'autre, sans croiser la vérification des codes.
+#define BATCH_MAX_OPS 100
+
+bool runBatch(JsonVariant request, JsonObject response);
+
+#endif
@@ -0,0 +1,47 @@
+#include "boot.h"
+#include "logger.h"
+#include <atomic>
+
+struct BootPhase {
+  const char* name;
+  uint32_t atUs;
+};
+
+// Marques posées par setup(), loop() et la tâche réseau
+static BootPhase phases[BOOT_MAX_PHASES];
+static std::atomic<uint8_t> phaseCount(0);
+static std::atomic<uint8_t> phasesReady(0);
+
+void bootMark(const char* phase) {
+  uint8_t slot = phaseCount.fetch_add(1);
+  if (slot >= BOOT_MAX_PHASES) return;
+
+  phases[slot] = {phase, (uint32_t)micros()};
+  phasesReady.fetch_add(1, std::memory_order_release);
+  LOG_I("⏱ Boot phase '%s' at %lu ms", phase, phases[slot].atUs / 1000);
+}
+
+uint32_t bootPhaseMs(const char* phase) {
+  uint8_t count = phasesReady.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < count && i < BOOT_MAX_PHASES; i++) {
+    if (phases[i].name && strcmp(phases[i].name, phase) == 0) return phases[i].atUs / 1000;
+  }
+  return 0;
+}
+
+// Chaque phase : instant de fin et durée depuis la phase précédente
+void bootToJson(JsonObject out) {
+  uint8_t count = min<uint8_t>(phasesReady.load(std::memory_order_acquire), BOOT_MAX_PHASES);
+
+  JsonArray list = out["phases"].to<JsonArray>();
+  uint32_t previous = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!phases[i].name) continue;
+    JsonObject phase = list.add<JsonObject>();
+    phase["name"] = phases[i].name;
+    phase["atMs"] = phases[i].atUs / 1000;
+    phase["tookMs"] = (phases[i].atUs - previous) / 1000;
+    previous = phases[i].atUs;
+  }
+  out["accessReadyMs"] = bootPhaseMs("access");
+}
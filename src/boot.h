@@ -0,0 +1,17 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== PHASES DE DÉMARRAGE =====
+// Horodatage de chaque étape du démarrage (depuis la mise sous tension) :
+// contrôle d'accès d'abord, réseau ensuite en arrière-plan. Exposé dans
+// /api/status et publié sur MQTT à la première connexion.
+#define BOOT_MAX_PHASES  12
+
+void bootMark(const char* phase);   // `phase` doit être un littéral
+uint32_t bootPhaseMs(const char* phase);
+void bootToJson(JsonObject out);
+
+#endif
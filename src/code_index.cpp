@@ -0,0 +1,108 @@
+#include "code_index.h"
+#include "config.h"
+#include "psram_alloc.h"
+#include "stats.h"
+#include "keypad.h"
+
+extern AccessCode* accessCodes;
+extern uint16_t* accessCodeGroups;
+extern int accessCodeCount;
+extern const char* accessCodeName(int index);
+
+static uint16_t* nameIndex = nullptr;  // Index des codes triés par nom
+static int nameIndexCount = -1;        // -1 = à reconstruire
+
+void codeIndexInvalidate() {
+  nameIndexCount = -1;
+}
+
+static int compareByName(const void* a, const void* b) {
+  int ia = *(const uint16_t*)a;
+  int ib = *(const uint16_t*)b;
+  int cmp = strcasecmp(accessCodeName(ia), accessCodeName(ib));
+  return cmp != 0 ? cmp : ia - ib;
+}
+
+static bool buildNameIndex() {
+  if (nameIndexCount == accessCodeCount) return true;
+
+  psramFree(nameIndex);
+  nameIndex = (uint16_t*)psramMalloc((accessCodeCount ? accessCodeCount : 1) * sizeof(uint16_t));
+  if (!nameIndex) {
+    nameIndexCount = -1;
+    return false;
+  }
+
+  for (int i = 0; i < accessCodeCount; i++) nameIndex[i] = i;
+  qsort(nameIndex, accessCodeCount, sizeof(uint16_t), compareByName);
+  nameIndexCount = accessCodeCount;
+  return true;
+}
+
+// Premier élément de l'index dont le nom est >= au préfixe
+static int lowerBound(const char* prefix, size_t len) {
+  int lo = 0, hi = nameIndexCount;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (strncasecmp(accessCodeName(nameIndex[mid]), prefix, len) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static bool matchesFilters(const CodeQuery& query, int i) {
+  if (query.type >= 0 && accessCodes[i].type != query.type) return false;
+  if (query.active >= 0 && accessCodes[i].active != query.active) return false;
+  return true;
+}
+
+static void addCode(JsonArray out, int i) {
+  JsonObject code = out.add<JsonObject>();
+  code["index"] = i;
+  code["code"] = (uint32_t)accessCodes[i].code;
+  code["type"] = (uint8_t)accessCodes[i].type;
+  if (accessCodes[i].type == 0) {
+    char pin[KEYPAD_MAX_DIGITS + 1];
+    keypadKeyToText(accessCodes[i].code, pin, sizeof(pin));
+    code["pin"] = pin;
+  }
+  code["name"] = accessCodeName(i);
+  code["active"] = (bool)accessCodes[i].active;
+  code["schedule"] = (uint8_t)accessCodes[i].schedule;
+  code["groups"] = accessCodeGroups[i];
+  
+  const CodeStats* usage = statsForCode(accessCodes[i].code, accessCodes[i].type);
+  code["uses"] = usage ? usage->uses : 0;
+  code["lastSeen"] = usage ? usage->lastSeen : 0;
+}
+
+// Remplit `out` avec la page demandée, retourne le nombre total de résultats
+int searchCodes(const CodeQuery& query, JsonArray out) {
+  int total = 0;
+  int end = query.offset + query.limit;
+  size_t prefixLen = query.prefix ? strlen(query.prefix) : 0;
+
+  // Sans préfixe (ou index indisponible) : ordre de la table
+  if (prefixLen == 0 || !buildNameIndex()) {
+    for (int i = 0; i < accessCodeCount; i++) {
+      if (prefixLen > 0 && strncasecmp(accessCodeName(i), query.prefix, prefixLen) != 0) continue;
+      if (!matchesFilters(query, i)) continue;
+      if (total >= query.offset && total < end) addCode(out, i);
+      total++;
+    }
+    return total;
+  }
+
+  // Avec préfixe : résultats triés par nom
+  for (int pos = lowerBound(query.prefix, prefixLen); pos < nameIndexCount; pos++) {
+    int i = nameIndex[pos];
+    if (strncasecmp(accessCodeName(i), query.prefix, prefixLen) != 0) break;
+    if (!matchesFilters(query, i)) continue;
+    if (total >= query.offset && total < end) addCode(out, i);
+    total++;
+  }
+  return total;
+}
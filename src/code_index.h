@@ -0,0 +1,26 @@
+#ifndef CODE_INDEX_H
+#define CODE_INDEX_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== RECHERCHE DANS LA TABLE DES CODES =====
+// Index des codes trié par nom (insensible à la casse), construit à la
+// première recherche et invalidé à chaque ajout/suppression. Une recherche
+// par préfixe est une recherche dichotomique suivie d'un parcours des seuls
+// codes correspondants.
+#define CODE_QUERY_DEFAULT_LIMIT  100
+#define CODE_QUERY_MAX_LIMIT      500
+
+struct CodeQuery {
+  const char* prefix;  // nullptr ou "" = pas de filtre sur le nom
+  int type;            // -1 = tous
+  int active;          // -1 = tous, 0 = inactifs, 1 = actifs
+  int offset;
+  int limit;
+};
+
+void codeIndexInvalidate();
+int searchCodes(const CodeQuery& query, JsonArray out);
+
+#endif
@@ -0,0 +1,209 @@
+#include "code_sync.h"
+#include "config.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include "schedule.h"
+#include "groups.h"
+#include "code_index.h"
+
+extern AccessCode* accessCodes;
+extern uint32_t* accessCodeNames;
+extern uint16_t* accessCodeGroups;
+extern int accessCodeCount;
+extern int accessCodeCapacity;
+
+extern const char* accessCodeName(int index);
+extern void loadAccessCodes();
+extern bool commitAccessCodes(uint32_t version);
+extern bool insertAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule,
+                             uint16_t groups);
+
+// ===== EMPREINTE =====
+static uint32_t fnv1a(uint32_t h, const void* data, size_t len) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) {
+    h ^= bytes[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+uint8_t syncBucketOf(uint32_t code, uint8_t type) {
+  uint32_t key = code ^ ((uint32_t)type << 30);
+  return fnv1a(2166136261u, &key, sizeof(key)) % SYNC_BUCKETS;
+}
+
+// Hash d'un code : tout ce qu'un serveur central peut modifier
+static uint32_t entryHash(int i) {
+  uint8_t flags[2] = {(uint8_t)accessCodes[i].type,
+                      (uint8_t)(accessCodes[i].active | (accessCodes[i].schedule << 1))};
+  uint32_t code = accessCodes[i].code;
+  uint16_t groups = accessCodeGroups[i];
+  const char* name = accessCodeName(i);
+
+  uint32_t h = 2166136261u;
+  h = fnv1a(h, &code, sizeof(code));
+  h = fnv1a(h, flags, sizeof(flags));
+  h = fnv1a(h, &groups, sizeof(groups));
+  return fnv1a(h, name, strlen(name));
+}
+
+// Somme des hashs par seau : indépendante de l'ordre de la table
+void computeCodeTableDigest(CodeTableDigest& digest) {
+  memset(&digest, 0, sizeof(digest));
+  for (int i = 0; i < accessCodeCount; i++) {
+    digest.buckets[syncBucketOf(accessCodes[i].code, accessCodes[i].type)] += entryHash(i);
+  }
+  digest.root = fnv1a(2166136261u, digest.buckets, sizeof(digest.buckets));
+}
+
+static void hashToHex(uint32_t hash, char* out) {
+  snprintf(out, 9, "%08lx", (unsigned long)hash);
+}
+
+void syncStateToJson(JsonObject out, bool withBuckets) {
+  CodeTableDigest digest;
+  computeCodeTableDigest(digest);
+
+  char hex[9];
+  hashToHex(digest.root, hex);
+  out["version"] = codeTableVersion;
+  out["count"] = accessCodeCount;
+  out["hash"] = hex;
+
+  if (withBuckets) {
+    JsonArray buckets = out["buckets"].to<JsonArray>();
+    for (int b = 0; b < SYNC_BUCKETS; b++) {
+      hashToHex(digest.buckets[b], hex);
+      buckets.add(hex);
+    }
+  }
+}
+
+// Contenu d'un seau, pour resynchroniser seulement ce qui diffère
+bool syncBucketToJson(int bucket, JsonObject out) {
+  if (bucket < 0 || bucket >= SYNC_BUCKETS) return false;
+
+  out["bucket"] = bucket;
+  out["version"] = codeTableVersion;
+  JsonArray codes = out["codes"].to<JsonArray>();
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (syncBucketOf(accessCodes[i].code, accessCodes[i].type) != bucket) continue;
+
+    JsonObject code = codes.add<JsonObject>();
+    code["code"] = (uint32_t)accessCodes[i].code;
+    code["type"] = (uint8_t)accessCodes[i].type;
+    code["name"] = accessCodeName(i);
+    code["active"] = (bool)accessCodes[i].active;
+    code["schedule"] = (uint8_t)accessCodes[i].schedule;
+    code["groups"] = accessCodeGroups[i];
+  }
+  return true;
+}
+
+// ===== APPLICATION D'UN DELTA =====
+static int findCode(uint32_t code, uint8_t type) {
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == code && accessCodes[i].type == type) return i;
+  }
+  return -1;
+}
+
+// Champs d'un nouveau code (delta de synchronisation, opérations par lot)
+bool validateCodeEntry(JsonVariant add, const char*& error) {
+  if (!add["code"].is<uint32_t>() || !add["type"].is<uint8_t>() || !add["name"].is<const char*>()) {
+    error = "code: champs manquants ou invalides";
+    return false;
+  }
+  uint8_t type = add["type"];
+  const char* name = add["name"];
+  uint8_t schedule = add["schedule"] | 0;
+  if (add["code"].as<uint32_t>() == 0 || type > 2) {
+    error = "code: code ou type invalide";
+    return false;
+  }
+  if (strlen(name) == 0 || strlen(name) > 31) {
+    error = "code: nom invalide (1-31 caractères)";
+    return false;
+  }
+  if (schedule > MAX_SCHEDULES || (schedule != 0 && !schedules[schedule].used)) {
+    error = "code: plage horaire inconnue";
+    return false;
+  }
+  return true;
+}
+
+// Format attendu :
+// {"base":12,"version":13,"remove":[{"code":1,"type":1}],
+//  "add":[{"code":2,"type":1,"name":"Badge","schedule":0,"groups":1,"active":true}]}
+// Tout ou rien : en cas d'échec la table est rechargée depuis la flash.
+bool applyCodeDelta(JsonVariant delta, const char*& error) {
+  uint32_t base = delta["base"] | 0;
+  uint32_t version = delta["version"] | 0;
+  JsonArray removes = delta["remove"];
+  JsonArray adds = delta["add"];
+
+  if (base != codeTableVersion) {
+    error = "version_mismatch";
+    return false;
+  }
+  if (version <= base) {
+    error = "version doit être > base";
+    return false;
+  }
+  if (removes.size() + adds.size() > SYNC_MAX_DELTA_OPS) {
+    error = "delta trop grand";
+    return false;
+  }
+
+  // Validation complète avant toute modification
+  for (JsonVariant remove : removes) {
+    if (findCode(remove["code"] | 0, remove["type"] | 0) < 0) {
+      error = "remove: code introuvable";
+      return false;
+    }
+  }
+  for (JsonVariant add : adds) {
+    if (!validateCodeEntry(add, error)) return false;
+  }
+  if (accessCodeCount - (int)removes.size() + (int)adds.size() > accessCodeCapacity) {
+    error = "capacité dépassée";
+    return false;
+  }
+
+  // Suppressions en un seul compactage de la table
+  for (JsonVariant remove : removes) {
+    int index = findCode(remove["code"] | 0, remove["type"] | 0);
+    if (index >= 0) accessCodes[index].code = 0;  // Marqué, jamais un code valide
+  }
+  int kept = 0;
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == 0) continue;
+    accessCodes[kept] = accessCodes[i];
+    accessCodeNames[kept] = accessCodeNames[i];
+    accessCodeGroups[kept] = accessCodeGroups[i];
+    kept++;
+  }
+  accessCodeCount = kept;
+  codeIndexInvalidate();
+
+  for (JsonVariant add : adds) {
+    if (!insertAccessCode(add["code"], add["type"], add["name"], add["schedule"] | 0,
+                          add["groups"] | GROUP_DEFAULT_MASK)) {
+      error = "add: doublon ou table pleine";
+      loadAccessCodes();  // Retour à l'état de la flash
+      return false;
+    }
+    if (!(add["active"] | true)) accessCodes[accessCodeCount - 1].active = false;
+  }
+
+  if (!commitAccessCodes(version)) {
+    error = "écriture flash impossible";
+    loadAccessCodes();
+    return false;
+  }
+
+  LOG_I("✓ Code delta applied: -%u +%u, version %lu -> %lu",
+        removes.size(), adds.size(), base, version);
+  return true;
+}
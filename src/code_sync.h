@@ -0,0 +1,31 @@
+#ifndef CODE_SYNC_H
+#define CODE_SYNC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== SYNCHRONISATION DE FLOTTE =====
+// La table des codes a une version (incrémentée à chaque écriture) et une
+// empreinte à deux niveaux : les codes sont répartis en SYNC_BUCKETS seaux
+// selon leur clé, chaque seau a un hash indépendant de l'ordre, et la racine
+// est le hash des seaux. Un serveur central compare la racine, puis les seaux
+// pour ne redemander que ceux qui diffèrent.
+// Depuis loop() seulement : applyCodeDelta() compacte la table en place.
+#define SYNC_BUCKETS        16
+#define SYNC_MAX_DELTA_OPS  500
+
+struct CodeTableDigest {
+  uint32_t root;
+  uint32_t buckets[SYNC_BUCKETS];
+};
+
+extern uint32_t codeTableVersion;
+
+uint8_t syncBucketOf(uint32_t code, uint8_t type);
+void computeCodeTableDigest(CodeTableDigest& digest);
+void syncStateToJson(JsonObject out, bool withBuckets);
+bool syncBucketToJson(int bucket, JsonObject out);
+bool validateCodeEntry(JsonVariant entry, const char*& error);
+bool applyCodeDelta(JsonVariant delta, const char*& error);
+
+#endif
@@ -17,12 +17,70 @@
 #define PIN_UP_SWITCH 25
 #define PIN_DOWN_SWITCH 26
 
+// ===== TABLE DES LECTEURS =====
+// Une ligne par lecteur Wiegand (D0, D1, LEDs, sens de passage). L'index de
+// la ligne est l'ID du lecteur, repris dans DOOR_TABLE, AccessLog et MQTT.
+#define MAX_READERS     4
+#define READER_DIR_IN   0  // Lecteur d'entrée
+#define READER_DIR_OUT  1  // Lecteur de sortie
+
+struct ReaderPins {
+  int8_t d0;
+  int8_t d1;
+  int8_t ledRed;
+  int8_t ledGreen;
+  uint8_t direction;
+};
+
+#define READER_TABLE { \
+  { WIEGAND_D0, WIEGAND_D1, READER_LED_RED, READER_LED_GREEN, READER_DIR_IN }, \
+}
+
+// ===== TABLE DES PORTES =====
+// Une ligne par porte pilotée par ce contrôleur (PIN_NONE = non câblé).
+// `reader` est l'index du lecteur Wiegand qui commande la porte.
+#define PIN_NONE  -1
+#define MAX_DOORS 4
+
+struct DoorPins {
+  int8_t relayOpen;
+  int8_t relayClose;
+  int8_t photoBarrier;
+  int8_t upSwitch;
+  int8_t downSwitch;
+  int8_t reader;
+};
+
+#define DOOR_TABLE { \
+  { RELAY_OPEN, RELAY_CLOSE, PHOTO_BARRIER, PIN_UP_SWITCH, PIN_DOWN_SWITCH, 0 }, \
+}
+
+// ===== CAPACITÉS DES TABLES =====
+// Valeurs par défaut selon la présence de PSRAM, modifiables via /api/config
+// (appliquées au prochain démarrage)
+#define DEFAULT_MAX_CODES_INTERNAL  50
+#define DEFAULT_MAX_LOGS_INTERNAL   100
+#define DEFAULT_MAX_CODES_PSRAM     2000
+#define DEFAULT_MAX_LOGS_PSRAM      1000
+#define MAX_CODES_LIMIT             10000
+#define MAX_LOGS_LIMIT              10000
+
+// Flash occupée par un code : table (11 o), nom (32 o max), statistiques
+// (20 o). La capacité est plafonnée à ce que la partition NVS peut contenir
+// deux fois (NVS garde l'ancienne version d'un blob pendant sa réécriture,
+// une restauration copie tout l'état, voir snapshot.h), hors
+// NVS_RESERVED_BYTES pour la configuration et la page de recyclage.
+#define NVS_BYTES_PER_CODE          64
+#define NVS_RESERVED_BYTES          12288
+
 // ===== STRUCTURES =====
-struct AccessCode {
+// Partie "chaude" d'un identifiant (5 octets) : seule lue pendant la
+// vérification. Le nom est stocké à part dans le pool de noms (name_pool.h).
+struct __attribute__((packed)) AccessCode {
   uint32_t code;
-  uint8_t type;  // 0=Wiegand/Keypad, 1=RFID, 2=Fingerprint
-  char name[32];
-  bool active;
+  uint8_t type : 2;    // 0=Wiegand/Keypad, 1=RFID, 2=Fingerprint
+  uint8_t active : 1;
+  uint8_t schedule : 5;  // Plage horaire (schedule.h), 0 = toujours autorisé
 };
 
 struct Config {
@@ -34,6 +92,9 @@ struct Config {
   char mqttPassword[32];
   char mqttTopic[64];
   char adminPassword[32];
+  char timezone[48];  // Chaîne TZ POSIX pour l'heure locale (SNTP)
+  uint16_t maxCodes;  // 0 = valeur par défaut selon la PSRAM
+  uint16_t maxLogs;
   bool initialized;
 };
 
@@ -42,6 +103,7 @@ struct AccessLog {
   uint32_t code;
   bool granted;
   uint8_t type;
+  uint8_t reader;  // Index dans READER_TABLE
 };
 
 #endif
@@ -0,0 +1,154 @@
+#include "door_commands.h"
+#include "doors.h"
+#include "logger.h"
+#include "scheduler.h"
+#include <atomic>
+
+struct DoorRequest {
+  uint8_t door;
+  int8_t target;  // % d'ouverture, DOOR_TARGET_STOP pour stop
+  uint8_t source;
+};
+
+// Dernière commande appliquée à chaque porte
+struct DoorArbiter {
+  uint8_t source;
+  int8_t target;
+  unsigned long appliedAt;
+};
+
+struct SourceCounters {
+  std::atomic<uint32_t> received;
+  std::atomic<uint32_t> applied;
+  std::atomic<uint32_t> coalesced;
+  std::atomic<uint32_t> rejected;
+};
+
+static QueueHandle_t doorQueue = nullptr;
+static DoorArbiter arbiters[MAX_DOORS];
+static SourceCounters counters[SOURCE_COUNT];
+
+void doorCommandsBegin() {
+  doorQueue = xQueueCreate(DOOR_QUEUE_LENGTH, sizeof(DoorRequest));
+  for (uint8_t d = 0; d < MAX_DOORS; d++) arbiters[d].target = DOOR_TARGET_STOP;
+}
+
+// ===== DÉPÔT (toute tâche) =====
+// Les commandes en pourcentage sont refusées tout de suite si la porte n'est pas calibrée
+bool submitDoorCommand(uint8_t door, int8_t target, CommandSource source) {
+  if (door >= doorCount || target > 100 || source >= SOURCE_COUNT || !doorQueue) return false;
+  if (target > 0 && target < 100 && !doorCalibrated(door)) return false;
+
+  counters[source].received++;
+  DoorRequest request = {door, target, source};
+  if (xQueueSend(doorQueue, &request, 0) != pdTRUE) {
+    counters[source].rejected++;
+    LOG_W("⚠ Door command queue full, command dropped (door %u)", door);
+    return false;
+  }
+  schedulerPost(EVENT_DOOR_COMMAND);
+  return true;
+}
+
+bool submitDoorAction(int door, const char* action, CommandSource source) {
+  int8_t target;
+  if (door < 0 || door >= doorCount || !parseDoorAction(action, target)) return false;
+  return submitDoorCommand(door, target, source);
+}
+
+// ===== ARBITRAGE (loop) =====
+// `candidate` remplace-t-il `current` dans la même rafale ?
+static bool wins(const DoorRequest& candidate, const DoorRequest& current) {
+  if (current.target == DOOR_TARGET_STOP) return false;
+  if (candidate.target == DOOR_TARGET_STOP) return true;
+  return candidate.source <= current.source;
+}
+
+static void applyRequest(const DoorRequest& request, unsigned long now) {
+  DoorArbiter& arbiter = arbiters[request.door];
+  bool moving = doors[request.door].phase != DOOR_IDLE;
+  SourceCounters& counter = counters[request.source];
+
+  if (request.target == DOOR_TARGET_STOP) {
+    if (!moving) {
+      counter.coalesced++;
+      return;
+    }
+    deactivateRelay(request.door);
+  } else {
+    if (arbiter.source == SOURCE_SAFETY && now - arbiter.appliedAt < DOOR_SAFETY_HOLD_MS) {
+      LOG_W("⚠ Door %u command ignored: safety hold", request.door);
+      counter.rejected++;
+      return;
+    }
+    bool sameTarget = request.target == arbiter.target;
+    if (sameTarget && (moving || now - arbiter.appliedAt < DOOR_COALESCE_MS)) {
+      counter.coalesced++;
+      return;
+    }
+    if (moving && request.source > arbiter.source) {
+      LOG_D("Door %u command from source %u ignored (source %u running)",
+            request.door, request.source, arbiter.source);
+      counter.rejected++;
+      return;
+    }
+    if (!doorMoveTo(request.door, request.target)) {
+      counter.rejected++;
+      return;
+    }
+  }
+
+  arbiter.source = request.source;
+  arbiter.target = request.target;
+  arbiter.appliedAt = now;
+  counter.applied++;
+}
+
+void doorCommandsUpdate() {
+  if (!doorQueue) return;
+
+  DoorRequest winners[MAX_DOORS];
+  bool pending[MAX_DOORS] = {false};
+  DoorRequest request;
+
+  while (xQueueReceive(doorQueue, &request, 0) == pdTRUE) {
+    if (!pending[request.door]) {
+      winners[request.door] = request;
+      pending[request.door] = true;
+    } else if (wins(request, winners[request.door])) {
+      counters[winners[request.door].source].coalesced++;
+      winners[request.door] = request;
+    } else {
+      counters[request.source].coalesced++;
+    }
+  }
+
+  unsigned long now = millis();
+  for (uint8_t d = 0; d < doorCount; d++) {
+    if (pending[d]) applyRequest(winners[d], now);
+  }
+}
+
+// Barrière : arrêt déjà fait par la machine d'états, on bloque les relances
+void doorSafetyStop(uint8_t door) {
+  if (door >= MAX_DOORS) return;
+  DoorArbiter& arbiter = arbiters[door];
+  arbiter.source = SOURCE_SAFETY;
+  arbiter.target = DOOR_TARGET_STOP;
+  arbiter.appliedAt = millis();
+  counters[SOURCE_SAFETY].received++;
+  counters[SOURCE_SAFETY].applied++;
+}
+
+// ===== EXPORT =====
+void doorCommandsToJson(JsonObject out) {
+  static const char* sourceNames[] = {"safety", "manual", "badge", "remote"};
+
+  for (uint8_t s = 0; s < SOURCE_COUNT; s++) {
+    JsonObject source = out[sourceNames[s]].to<JsonObject>();
+    source["received"] = counters[s].received.load();
+    source["applied"] = counters[s].applied.load();
+    source["coalesced"] = counters[s].coalesced.load();
+    source["rejected"] = counters[s].rejected.load();
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef DOOR_COMMANDS_H
+#define DOOR_COMMANDS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== ARBITRAGE DES COMMANDES =====
+// Web, MQTT, interrupteurs et badges déposent leurs commandes dans une file
+// unique, vidée par loop() avant doorsUpdate(). Pour chaque porte, une rafale
+// se réduit à une seule manœuvre :
+//  - "stop" l'emporte sur tout ;
+//  - sinon la source la plus prioritaire gagne (sécurité > manuel > badge > distant),
+//    à priorité égale la plus récente ;
+//  - une course en cours n'est pas interrompue par une source moins prioritaire ;
+//  - une commande identique à la course en cours, ou à la précédente depuis moins
+//    de DOOR_COALESCE_MS, est fusionnée au lieu de relancer le relais.
+#define DOOR_QUEUE_LENGTH     16
+#define DOOR_COALESCE_MS      1500
+#define DOOR_SAFETY_HOLD_MS   3000  // Après la barrière, seules les commandes stop passent
+
+enum CommandSource : uint8_t {
+  SOURCE_SAFETY,  // Par ordre de priorité décroissante
+  SOURCE_MANUAL,
+  SOURCE_BADGE,
+  SOURCE_REMOTE,
+  SOURCE_COUNT
+};
+
+void doorCommandsBegin();
+bool submitDoorCommand(uint8_t door, int8_t target, CommandSource source);
+bool submitDoorAction(int door, const char* action, CommandSource source);
+void doorCommandsUpdate();
+void doorSafetyStop(uint8_t door);
+void doorCommandsToJson(JsonObject out);
+
+#endif
@@ -0,0 +1,429 @@
+#include "doors.h"
+#include "logger.h"
+#include "metrics.h"
+#include "door_commands.h"
+#include "events.h"
+#include "scheduler.h"
+#include <Preferences.h>
+#include <math.h>
+
+extern Preferences preferences;
+extern Config config;
+extern bool publishMQTT(const char* topic, const char* payload);
+
+const DoorPins doorPins[] = DOOR_TABLE;
+const uint8_t doorCount = sizeof(doorPins) / sizeof(doorPins[0]);
+static_assert(sizeof(doorPins) / sizeof(doorPins[0]) <= MAX_DOORS, "DOOR_TABLE: trop de portes");
+
+Door doors[MAX_DOORS];
+
+// ===== ACCÈS AUX BROCHES =====
+static void writePin(int8_t pin, uint8_t level) {
+  if (pin != PIN_NONE) digitalWrite(pin, level);
+}
+
+static bool pinIsHigh(int8_t pin) {
+  return pin != PIN_NONE && digitalRead(pin) == HIGH;
+}
+
+static bool pinIsLow(int8_t pin) {
+  return pin != PIN_NONE && digitalRead(pin) == LOW;
+}
+
+// La porte 0 publie aussi sur les topics historiques (roller/relay, ...).
+// durable = gardé et publié plus tard si MQTT est absent
+static void publishDoor(uint8_t door, const char* subtopic, const char* payload, bool durable = false) {
+  bool (*publish)(const char*, const char*) = durable ? publishEvent : publishMQTT;
+  if (door == 0) publish(subtopic, payload);
+
+  char topic[32];
+  snprintf(topic, sizeof(topic), "door/%u/%s", door, subtopic);
+  publish(topic, payload);
+}
+
+// ===== INITIALISATION =====
+// Relais coupés le plus tôt possible au démarrage
+void doorsBegin() {
+  for (uint8_t d = 0; d < doorCount; d++) {
+    const DoorPins& pins = doorPins[d];
+    if (pins.relayOpen != PIN_NONE) pinMode(pins.relayOpen, OUTPUT);
+    if (pins.relayClose != PIN_NONE) pinMode(pins.relayClose, OUTPUT);
+    if (pins.photoBarrier != PIN_NONE) pinMode(pins.photoBarrier, INPUT_PULLUP);
+    writePin(pins.relayOpen, LOW);
+    writePin(pins.relayClose, LOW);
+    doors[d].phase = DOOR_IDLE;
+  }
+  doorCommandsBegin();
+}
+
+void loadDoors() {
+  DoorSettings stored[MAX_DOORS];
+  size_t len = preferences.getBytes("doors", stored, sizeof(stored));
+
+  for (uint8_t d = 0; d < doorCount; d++) {
+    if (len == sizeof(stored)) {
+      doors[d].settings = stored[d];
+      doors[d].settings.name[DOOR_NAME_LEN - 1] = '\0';
+    } else {
+      snprintf(doors[d].settings.name, DOOR_NAME_LEN, "Porte %u", d + 1);
+      doors[d].settings.relayDuration = 0;
+      doors[d].settings.photoBarrierEnabled = true;
+    }
+  }
+
+  DoorTravel travel[MAX_DOORS];
+  if (preferences.getBytes("doorTravel", travel, sizeof(travel)) != sizeof(travel)) {
+    memset(travel, 0, sizeof(travel));
+  }
+  for (uint8_t d = 0; d < doorCount; d++) {
+    doors[d].travel = travel[d];
+    doors[d].position = DOOR_POSITION_UNKNOWN;  // Recalée à la première fin de course
+    doors[d].pendingTarget = -1;
+  }
+  LOG_I("✓ %u door(s) configured", doorCount);
+}
+
+void saveDoors() {
+  DoorSettings stored[MAX_DOORS];
+  memset(stored, 0, sizeof(stored));
+  for (uint8_t d = 0; d < doorCount; d++) stored[d] = doors[d].settings;
+
+  preferences.putBytes("doors", stored, sizeof(stored));
+
+  DoorTravel travel[MAX_DOORS];
+  memset(travel, 0, sizeof(travel));
+  for (uint8_t d = 0; d < doorCount; d++) travel[d] = doors[d].travel;
+  preferences.putBytes("doorTravel", travel, sizeof(travel));
+  LOG_I("✓ Door settings saved to flash");
+}
+
+uint32_t doorRelayDuration(uint8_t door) {
+  uint32_t duration = doors[door].settings.relayDuration;
+  return duration ? duration : config.relayDuration;
+}
+
+// ===== POSITION =====
+// Position à l'instant `now` : position de départ plus la part de course
+// parcourue depuis la fin du délai de démarrage du moteur
+static float estimatePosition(const Door& state, unsigned long now) {
+  if (state.phase != DOOR_RUNNING || state.position < 0) return state.position;
+
+  uint32_t travelMs = state.open ? state.travel.openMs : state.travel.closeMs;
+  if (travelMs == 0) return DOOR_POSITION_UNKNOWN;  // Non calibrée
+
+  long movingMs = (long)(now - state.phaseStart) - state.travel.startDelayMs;
+  if (movingMs <= 0) return state.position;
+
+  float moved = movingMs * 100.0f / travelMs;
+  return constrain(state.open ? state.position + moved : state.position - moved, 0.0f, 100.0f);
+}
+
+float doorPosition(uint8_t door) {
+  if (door >= doorCount) return DOOR_POSITION_UNKNOWN;
+  return estimatePosition(doors[door], millis());
+}
+
+// Durée de relais pour aller de la position courante à la cible. Vers une
+// butée, la course est prolongée de DOOR_END_MARGIN_PCT pour recaler la position.
+static uint32_t travelDuration(uint8_t d) {
+  const Door& state = doors[d];
+  uint32_t travelMs = state.open ? state.travel.openMs : state.travel.closeMs;
+  if (travelMs == 0) return doorRelayDuration(d);
+
+  float distance = state.position < 0 ? 100.0f : fabsf(state.target - state.position);
+  uint32_t duration = state.travel.startDelayMs + (uint32_t)(distance * travelMs / 100.0f);
+  if (state.target == (state.open ? 100 : 0)) duration += travelMs * DOOR_END_MARGIN_PCT / 100;
+  return duration;
+}
+
+static void publishPosition(uint8_t door) {
+  char payload[32];
+  if (doors[door].position < 0) {
+    strcpy(payload, "{\"position\":null}");
+  } else {
+    snprintf(payload, sizeof(payload), "{\"position\":%ld}", lroundf(doors[door].position));
+  }
+  publishDoor(door, "position", payload);
+}
+
+// ===== COMMANDE DES RELAIS =====
+static void startMove(uint8_t door, bool open, int8_t target) {
+  const DoorPins& pins = doorPins[door];
+  Door& state = doors[door];
+
+  // SÉCURITÉ 1: Ne jamais activer les 2 relais simultanément !
+  writePin(pins.relayOpen, LOW);
+  writePin(pins.relayClose, LOW);
+
+  // SÉCURITÉ 2: Vérifier que l'autre relais est bien OFF
+  if (pinIsHigh(open ? pins.relayClose : pins.relayOpen)) {
+    LOG_E("⚠ ERREUR: door %u, %s encore actif!", door, open ? "RELAY_CLOSE" : "RELAY_OPEN");
+    return;
+  }
+
+  if (state.phase == DOOR_RUNNING) {
+    metricsRelayStopped(door, state.open, millis() - state.phaseStart, false);
+    state.position = estimatePosition(state, millis());
+    LOG_I("⚡ Relay deactivated (door %u)", door);
+    publishDoor(door, "relay", "{\"action\":\"stopped\"}");
+  }
+
+  // Le relais sera activé par doorsUpdate() après le temps mort de sécurité
+  state.open = open;
+  state.target = target;
+  state.pendingTarget = -1;
+  state.phase = DOOR_DEADTIME;
+  state.phaseStart = millis();
+}
+
+void activateRelay(bool open, uint8_t door) {
+  if (door >= doorCount) return;
+  startMove(door, open, open ? 100 : 0);
+}
+
+// completed = fin normale de la temporisation (pour la télémétrie)
+static void stopRelay(uint8_t door, bool completed) {
+  Door& state = doors[door];
+
+  writePin(doorPins[door].relayOpen, LOW);
+  writePin(doorPins[door].relayClose, LOW);
+  if (state.phase == DOOR_RUNNING) {
+    metricsRelayStopped(door, state.open, millis() - state.phaseStart, completed);
+    state.position = completed ? state.target : estimatePosition(state, millis());
+  }
+  state.phase = DOOR_IDLE;
+
+  LOG_I("⚡ Relay deactivated (door %u)", door);
+  publishDoor(door, "relay", "{\"action\":\"stopped\"}");
+  publishPosition(door);
+
+  // Butée atteinte après recalage : reprise du déplacement demandé
+  int8_t pending = state.pendingTarget;
+  state.pendingTarget = -1;
+  if (completed && pending >= 0) doorMoveTo(door, pending);
+}
+
+void deactivateRelay(uint8_t door) {
+  if (door >= doorCount) return;
+  stopRelay(door, false);
+}
+
+void openDoorsForReader(uint8_t reader) {
+  for (uint8_t d = 0; d < doorCount; d++) {
+    if (doorPins[d].reader == reader) submitDoorCommand(d, 100, SOURCE_BADGE);
+  }
+}
+
+// Déplacement vers un pourcentage d'ouverture (0 = fermé, 100 = ouvert)
+bool doorMoveTo(uint8_t door, int percent) {
+  if (door >= doorCount || percent < 0 || percent > 100) return false;
+  Door& state = doors[door];
+
+  if (percent == 0 || percent == 100) {
+    activateRelay(percent == 100, door);
+    return true;
+  }
+  if (!doorCalibrated(door)) {
+    LOG_W("⚠ Door %u not calibrated, position command ignored", door);
+    return false;
+  }
+
+  float position = estimatePosition(state, millis());
+  if (position < 0) {
+    // Position inconnue : butée la plus proche de la cible d'abord
+    startMove(door, percent >= 50, percent >= 50 ? 100 : 0);
+    state.pendingTarget = percent;
+    LOG_I("Door %u position unknown: homing before moving to %d%%", door, percent);
+  } else if (fabsf(position - percent) < 1.0f) {
+    if (state.phase != DOOR_IDLE) deactivateRelay(door);
+  } else {
+    startMove(door, percent > position, percent);
+  }
+  return true;
+}
+
+// "40%" ou "open 40%" -> 40, -1 si ce n'est pas un pourcentage
+static int parsePercent(const char* action) {
+  if (strncmp(action, "open ", 5) == 0) action += 5;
+
+  char* end;
+  long percent = strtol(action, &end, 10);
+  if (end == action || strcmp(end, "%") != 0 || percent < 0 || percent > 100) return -1;
+  return percent;
+}
+
+// Action texte commune au web et au MQTT : "open", "close", "stop" ou un
+// pourcentage d'ouverture ("40%", "open 40%"). target = DOOR_TARGET_STOP pour stop.
+bool parseDoorAction(const char* action, int8_t& target) {
+  if (action == nullptr) return false;
+
+  if (strcmp(action, "open") == 0) {
+    target = 100;
+  } else if (strcmp(action, "close") == 0) {
+    target = 0;
+  } else if (strcmp(action, "stop") == 0) {
+    target = DOOR_TARGET_STOP;
+  } else {
+    int percent = parsePercent(action);
+    if (percent < 0) return false;
+    target = percent;
+  }
+  return true;
+}
+
+bool doorActionValid(const char* action) {
+  int8_t target;
+  return parseDoorAction(action, target);
+}
+
+bool doorCalibrated(uint8_t door) {
+  return door < doorCount && doors[door].travel.openMs > 0 && doors[door].travel.closeMs > 0;
+}
+
+// ===== MACHINES D'ÉTATS =====
+static void stepDoor(uint8_t d, unsigned long now) {
+  const DoorPins& pins = doorPins[d];
+  Door& state = doors[d];
+
+  switch (state.phase) {
+    case DOOR_DEADTIME:
+      if (now - state.phaseStart >= DOOR_DEADTIME_MS) {
+        writePin(state.open ? pins.relayOpen : pins.relayClose, HIGH);
+        state.phase = DOOR_RUNNING;
+        state.phaseStart = now;
+        metricsRelayStarted(d, state.open);
+
+        uint32_t duration = travelDuration(d);
+        state.runDuration = duration;
+        LOG_I("⚡ Relay activated: door %u %s to %d%% for %lums", d, state.open ? "OPEN" : "CLOSE",
+              state.target, duration);
+
+        char payload[128];
+        snprintf(payload, sizeof(payload),
+                 "{\"action\":\"%s\",\"duration\":%lu,\"target\":%d}",
+                 state.open ? "open" : "close", duration, state.target);
+        publishDoor(d, "relay", payload);
+      }
+      break;
+
+    case DOOR_RUNNING:
+      if (now - state.phaseStart >= state.runDuration) {
+        stopRelay(d, true);
+      } else if (config.photoBarrierEnabled && state.settings.photoBarrierEnabled &&
+                 pinIsLow(pins.photoBarrier)) {  // Barrière coupée
+        LOG_W("⚠ Photo barrier triggered on door %u! Stopping relay.", d);
+        metricsBarrierTrip(d);
+        stopRelay(d, false);
+        doorSafetyStop(d);
+        publishDoor(d, "status", "{\"event\":\"barrier_triggered\"}", true);
+      }
+      break;
+
+    case DOOR_IDLE:
+      break;
+  }
+}
+
+// Prochaine échéance d'une porte : fin du temps mort ou de la course,
+// au plus DOOR_BARRIER_POLL_MS tant que la barrière doit être surveillée
+static uint32_t doorNextWakeMs(uint8_t d, unsigned long now) {
+  const Door& state = doors[d];
+  uint32_t elapsed = now - state.phaseStart;
+
+  switch (state.phase) {
+    case DOOR_DEADTIME:
+      return elapsed >= DOOR_DEADTIME_MS ? 0 : DOOR_DEADTIME_MS - elapsed;
+    case DOOR_RUNNING: {
+      uint32_t remaining = elapsed >= state.runDuration ? 0 : state.runDuration - elapsed;
+      bool barrierWatched = config.photoBarrierEnabled && state.settings.photoBarrierEnabled &&
+                            doorPins[d].photoBarrier != PIN_NONE;
+      return barrierWatched ? min(remaining, (uint32_t)DOOR_BARRIER_POLL_MS) : remaining;
+    }
+    default:
+      return UINT32_MAX;
+  }
+}
+
+void doorsUpdate() {
+  unsigned long now = millis();
+  uint32_t wake = UINT32_MAX;
+  for (uint8_t d = 0; d < doorCount; d++) {
+    stepDoor(d, now);
+    wake = min(wake, doorNextWakeMs(d, now));
+  }
+  if (wake != UINT32_MAX) timerArm(TIMER_DOORS, wake);
+}
+
+// ===== API =====
+// Format attendu : {"door":1,"name":"Portail","relayDuration":8000,"photoEnabled":false,
+//                   "openTime":21000,"closeTime":19000,"startDelay":400}
+bool updateDoor(JsonVariant json, const char*& error) {
+  int door = json["door"] | -1;
+  if (door < 0 || door >= doorCount) {
+    error = "Porte inconnue";
+    return false;
+  }
+
+  // Calibration : durées mesurées d'une course complète dans chaque sens
+  DoorSettings settings = doors[door].settings;
+  DoorTravel travel = doors[door].travel;
+  travel.openMs = json["openTime"] | travel.openMs;
+  travel.closeMs = json["closeTime"] | travel.closeMs;
+  travel.startDelayMs = json["startDelay"] | travel.startDelayMs;
+  if (travel.openMs > 120000 || travel.closeMs > 120000) {
+    error = "Durée de course invalide (0-120000 ms, 0 = non calibrée)";
+    return false;
+  }
+  if (travel.startDelayMs > 5000) {
+    error = "Délai de démarrage invalide (0-5000 ms)";
+    return false;
+  }
+
+  if (json["relayDuration"].is<uint32_t>()) {
+    uint32_t duration = json["relayDuration"];
+    if (duration > 60000) {
+      error = "Durée invalide (0-60000 ms, 0 = globale)";
+      return false;
+    }
+    settings.relayDuration = duration;
+  }
+  if (json["name"].is<const char*>()) strlcpy(settings.name, json["name"], DOOR_NAME_LEN);
+  if (json["photoEnabled"].is<bool>()) settings.photoBarrierEnabled = json["photoEnabled"];
+
+  doors[door].settings = settings;
+  doors[door].travel = travel;
+  saveDoors();
+  return true;
+}
+
+void doorsToJson(JsonArray out) {
+  static const char* phaseNames[] = {"idle", "starting", "running"};
+
+  for (uint8_t d = 0; d < doorCount; d++) {
+    const DoorPins& pins = doorPins[d];
+    const Door& state = doors[d];
+
+    JsonObject door = out.add<JsonObject>();
+    door["door"] = d;
+    door["name"] = state.settings.name;
+    door["state"] = phaseNames[state.phase];
+    if (state.phase != DOOR_IDLE) {
+      door["direction"] = state.open ? "open" : "close";
+      door["target"] = state.target;
+    }
+    float position = estimatePosition(state, millis());
+    if (position < 0) {
+      door["position"] = nullptr;
+    } else {
+      door["position"] = lroundf(position);
+    }
+    door["calibrated"] = doorCalibrated(d);
+    door["openTime"] = state.travel.openMs;
+    door["closeTime"] = state.travel.closeMs;
+    door["startDelay"] = state.travel.startDelayMs;
+    door["relayDuration"] = doorRelayDuration(d);
+    door["photoEnabled"] = state.settings.photoBarrierEnabled;
+    if (pins.photoBarrier != PIN_NONE) door["barrier"] = digitalRead(pins.photoBarrier);
+    door["reader"] = pins.reader;
+  }
+}
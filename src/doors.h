@@ -0,0 +1,73 @@
+#ifndef DOORS_H
+#define DOORS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// ===== PORTES =====
+// Chaque porte de DOOR_TABLE a sa propre machine d'états, avancée par
+// doorsUpdate() à chaque échéance (TIMER_DOORS) ou commande : aucune attente
+// bloquante, le temps de boucle ne dépend pas du nombre de portes.
+#define DOOR_NAME_LEN     16
+#define DOOR_DEADTIME_MS  100  // Les deux relais coupés avant d'en activer un
+#define DOOR_BARRIER_POLL_MS  10  // Surveillance de la barrière pendant une course
+
+enum DoorPhase : uint8_t {
+  DOOR_IDLE,      // Relais coupés
+  DOOR_DEADTIME,  // Relais coupés, activation demandée
+  DOOR_RUNNING    // Relais actif jusqu'à la fin de la temporisation
+};
+
+// Réglages modifiables via l'API, persistés dans le blob NVS "doors"
+struct DoorSettings {
+  char name[DOOR_NAME_LEN];
+  uint32_t relayDuration;    // 0 = config.relayDuration
+  bool photoBarrierEnabled;  // En plus de config.photoBarrierEnabled
+};
+
+// Calibration de la course, blob NVS "doorTravel" (0 = non calibrée :
+// chaque commande dure relayDuration et seules les fins de course sont connues)
+#define DOOR_POSITION_UNKNOWN  -1.0f
+#define DOOR_TARGET_STOP       -1   // Cible "stop" des commandes texte
+#define DOOR_END_MARGIN_PCT    10   // Dépassement en fin de course pour recaler la position
+
+struct DoorTravel {
+  uint32_t openMs;       // Durée d'ouverture complète
+  uint32_t closeMs;      // Durée de fermeture complète
+  uint16_t startDelayMs; // Délai entre le relais et le mouvement du tablier
+};
+
+struct Door {
+  DoorPhase phase;
+  bool open;                 // Sens demandé
+  unsigned long phaseStart;
+  float position;            // % d'ouverture estimé (au départ de la course en cours)
+  int8_t target;             // % visé par la course en cours
+  int8_t pendingTarget;      // % visé après recalage en fin de course, -1 = aucun
+  uint32_t runDuration;      // Durée de la course en cours
+  DoorSettings settings;
+  DoorTravel travel;
+};
+
+extern const DoorPins doorPins[];
+extern const uint8_t doorCount;
+extern Door doors[];
+
+void doorsBegin();
+void loadDoors();
+void saveDoors();
+void doorsUpdate();
+void activateRelay(bool open, uint8_t door = 0);
+void deactivateRelay(uint8_t door = 0);
+void openDoorsForReader(uint8_t reader);
+bool doorMoveTo(uint8_t door, int percent);
+bool parseDoorAction(const char* action, int8_t& target);
+bool doorActionValid(const char* action);
+bool doorCalibrated(uint8_t door);
+float doorPosition(uint8_t door);
+uint32_t doorRelayDuration(uint8_t door);
+bool updateDoor(JsonVariant json, const char*& error);
+void doorsToJson(JsonArray out);
+
+#endif
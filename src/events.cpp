@@ -0,0 +1,92 @@
+#include "events.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include <PubSubClient.h>
+
+extern PubSubClient mqttClient;
+extern bool publishMQTT(const char* topic, const char* payload);
+
+struct BufferedEvent {
+  uint32_t at;
+  char topic[EVENT_TOPIC_LEN];
+  char payload[EVENT_PAYLOAD_LEN];
+};
+
+// Anneau alloué à la première coupure : rien en mémoire si le réseau tient
+static BufferedEvent* events = nullptr;
+static uint16_t eventHead = 0;   // Prochain à publier
+static uint16_t eventCount = 0;
+static uint32_t eventsDropped = 0;
+static uint32_t eventsDelivered = 0;
+static uint32_t eventsRejected = 0;
+
+static bool bufferEvent(const char* subtopic, const char* payload) {
+  if (strlen(subtopic) >= EVENT_TOPIC_LEN || strlen(payload) >= EVENT_PAYLOAD_LEN) {
+    LOG_E("✗ Event too long for the buffer, rejected (%s, %u bytes)", subtopic, strlen(payload));
+    eventsRejected++;
+    return false;
+  }
+  if (!events) {
+    events = (BufferedEvent*)psramCalloc(EVENT_BUFFER_SIZE, sizeof(BufferedEvent));
+    if (!events) {
+      eventsDropped++;
+      return false;
+    }
+  }
+
+  if (eventCount == EVENT_BUFFER_SIZE) {
+    eventHead = (eventHead + 1) % EVENT_BUFFER_SIZE;  // Le plus ancien est perdu
+    eventCount--;
+    eventsDropped++;
+  }
+
+  BufferedEvent& event = events[(eventHead + eventCount) % EVENT_BUFFER_SIZE];
+  event.at = millis();
+  strlcpy(event.topic, subtopic, sizeof(event.topic));
+  strlcpy(event.payload, payload, sizeof(event.payload));
+  eventCount++;
+  return true;
+}
+
+// Depuis loop() uniquement (même tâche que le client MQTT)
+bool publishEvent(const char* subtopic, const char* payload) {
+  // Ordre conservé : tant que l'anneau n'est pas vidé, on y ajoute
+  if (eventCount == 0 && publishMQTT(subtopic, payload)) return true;
+  return bufferEvent(subtopic, payload);
+}
+
+void eventsFlush() {
+  if (eventCount == 0 || !mqttClient.connected()) return;
+
+  for (uint8_t i = 0; i < EVENT_FLUSH_PER_LOOP && eventCount > 0; i++) {
+    BufferedEvent& event = events[eventHead];
+
+    // {"code":...} -> {"code":...,"delayedMs":N}
+    char payload[EVENT_PAYLOAD_LEN + 32];
+    size_t len = strlen(event.payload);
+    if (len > 0 && event.payload[len - 1] == '}') {
+      snprintf(payload, sizeof(payload), "%.*s,\"delayedMs\":%lu}",
+               (int)(len - 1), event.payload, millis() - event.at);
+    } else {
+      strlcpy(payload, event.payload, sizeof(payload));
+    }
+    // Échec : l'événement reste en tête, repris au prochain passage
+    if (!publishMQTT(event.topic, payload)) {
+      LOG_W("⚠ Buffered event not delivered, %u kept", eventCount);
+      return;
+    }
+
+    eventHead = (eventHead + 1) % EVENT_BUFFER_SIZE;
+    eventCount--;
+    eventsDelivered++;
+  }
+
+  if (eventCount == 0) LOG_I("✓ Buffered events delivered (%lu total)", eventsDelivered);
+}
+
+void eventsToJson(JsonObject out) {
+  out["pending"] = eventCount;
+  out["delivered"] = eventsDelivered;
+  out["dropped"] = eventsDropped;
+  out["rejected"] = eventsRejected;
+}
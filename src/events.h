@@ -0,0 +1,24 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== ÉVÉNEMENTS DIFFÉRÉS =====
+// Accès et déclenchements de barrière ne doivent pas être perdus quand le
+// broker (ou le WiFi) est absent : ils sont gardés dans un anneau en PSRAM
+// et publiés dans l'ordre à la reconnexion, avec leur retard en ms
+// ("delayedMs"). Plein, l'anneau écrase les plus anciens. Une publication
+// refusée par le client MQTT garde l'événement dans l'anneau. Un message plus
+// long que EVENT_PAYLOAD_LEN est refusé entier plutôt que tronqué (JSON
+// invalide).
+#define EVENT_BUFFER_SIZE     128
+#define EVENT_TOPIC_LEN       24
+#define EVENT_PAYLOAD_LEN     224
+#define EVENT_FLUSH_PER_LOOP  8    // Publications par tour de boucle au plus
+
+bool publishEvent(const char* subtopic, const char* payload);  // Faux si refusé ou perdu
+void eventsFlush();
+void eventsToJson(JsonObject out);
+
+#endif
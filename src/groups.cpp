@@ -0,0 +1,82 @@
+#include "groups.h"
+#include "logger.h"
+#include <Preferences.h>
+
+extern Preferences preferences;
+extern uint16_t* accessCodeGroups;
+extern int accessCodeCount;
+
+uint16_t groupsEnabled = GROUP_DEFAULT_MASK;
+char groupNames[MAX_GROUPS][GROUP_NAME_LEN];
+
+void loadGroups() {
+  groupsEnabled = preferences.getUShort("grpMask", GROUP_DEFAULT_MASK);
+
+  if (preferences.getBytes("grpNames", groupNames, sizeof(groupNames)) != sizeof(groupNames)) {
+    memset(groupNames, 0, sizeof(groupNames));
+    strlcpy(groupNames[0], "Default", GROUP_NAME_LEN);
+  }
+  for (int g = 0; g < MAX_GROUPS; g++) groupNames[g][GROUP_NAME_LEN - 1] = '\0';
+
+  LOG_I("✓ Groups loaded: enabled mask=0x%04X", groupsEnabled);
+}
+
+bool setGroupEnabled(int group, bool enabled) {
+  if (group < 0 || group >= MAX_GROUPS) return false;
+
+  uint16_t mask = enabled ? (groupsEnabled | (1u << group))
+                          : (groupsEnabled & ~(1u << group));
+  if (mask == groupsEnabled) return true;
+
+  groupsEnabled = mask;
+  preferences.putUShort("grpMask", groupsEnabled);
+  LOG_I("✓ Group %d %s (mask=0x%04X)", group, enabled ? "enabled" : "revoked", groupsEnabled);
+  return true;
+}
+
+bool setGroupName(int group, const char* name) {
+  if (group < 0 || group >= MAX_GROUPS || name == nullptr) return false;
+  if (strncmp(groupNames[group], name, GROUP_NAME_LEN - 1) == 0) return true;
+
+  strlcpy(groupNames[group], name, GROUP_NAME_LEN);
+  preferences.putBytes("grpNames", groupNames, sizeof(groupNames));
+  return true;
+}
+
+// Format attendu : {"id":2,"enabled":false} et/ou {"id":2,"name":"Livreurs"}
+bool updateGroup(JsonVariant json, const char*& error) {
+  int group = json["id"] | -1;
+  if (group < 0 || group >= MAX_GROUPS) {
+    error = "ID de groupe invalide (0-15)";
+    return false;
+  }
+  if (!json["enabled"].is<bool>() && !json["name"].is<const char*>()) {
+    error = "enabled ou name requis";
+    return false;
+  }
+
+  if (json["name"].is<const char*>()) setGroupName(group, json["name"]);
+  if (json["enabled"].is<bool>()) setGroupEnabled(group, json["enabled"]);
+  return true;
+}
+
+void groupsToJson(JsonObject out) {
+  out["enabledMask"] = groupsEnabled;
+
+  // Nombre de membres : un seul passage sur les appartenances
+  uint16_t members[MAX_GROUPS] = {0};
+  for (int i = 0; i < accessCodeCount; i++) {
+    for (uint16_t bits = accessCodeGroups[i]; bits; bits &= bits - 1) {
+      members[__builtin_ctz(bits)]++;
+    }
+  }
+
+  JsonArray list = out["groups"].to<JsonArray>();
+  for (int g = 0; g < MAX_GROUPS; g++) {
+    JsonObject group = list.add<JsonObject>();
+    group["id"] = g;
+    group["name"] = groupNames[g];
+    group["enabled"] = (groupsEnabled >> g) & 1;
+    group["members"] = members[g];
+  }
+}
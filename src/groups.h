@@ -0,0 +1,29 @@
+#ifndef GROUPS_H
+#define GROUPS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== GROUPES =====
+// Chaque code appartient à un ou plusieurs groupes (bitset de 16 bits,
+// accessCodeGroups[]). `groupsEnabled` liste les groupes autorisés : retirer
+// ou rendre l'accès à tout un groupe est une seule écriture de 2 octets.
+#define MAX_GROUPS          16
+#define GROUP_DEFAULT_MASK  0x0001  // Groupe 0 "Défaut", membre par défaut
+#define GROUP_NAME_LEN      16
+
+extern uint16_t groupsEnabled;
+extern char groupNames[MAX_GROUPS][GROUP_NAME_LEN];
+
+void loadGroups();
+bool setGroupEnabled(int group, bool enabled);
+bool setGroupName(int group, const char* name);
+bool updateGroup(JsonVariant json, const char*& error);
+void groupsToJson(JsonObject out);
+
+// Résolution de la permission : un seul ET logique
+inline bool groupsAllow(uint16_t membership) {
+  return (membership & groupsEnabled) != 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "json_body.h"
+#include "psram_alloc.h"
+#include "logger.h"
+
+// ===== BUDGET DU DOCUMENT =====
+// Allocateur ArduinoJson propre à une requête : PSRAM, plafonné à `budget`
+// octets. Chaque bloc porte sa taille pour rendre le budget à la libération.
+class BoundedJsonAllocator : public ArduinoJson::Allocator {
+ public:
+  explicit BoundedJsonAllocator(size_t budget) : remaining(budget) {}
+
+  void* allocate(size_t size) override {
+    if (size > remaining) return nullptr;
+    size_t* block = (size_t*)psramMalloc(size + HEADER);
+    if (!block) return nullptr;
+    *block = size;
+    remaining -= size;
+    return (uint8_t*)block + HEADER;
+  }
+
+  void deallocate(void* ptr) override {
+    if (!ptr) return;
+    size_t* block = (size_t*)((uint8_t*)ptr - HEADER);
+    remaining += *block;
+    psramFree(block);
+  }
+
+  void* reallocate(void* ptr, size_t newSize) override {
+    if (!ptr) return allocate(newSize);
+    size_t* block = (size_t*)((uint8_t*)ptr - HEADER);
+    size_t oldSize = *block;
+    if (newSize > oldSize && newSize - oldSize > remaining) return nullptr;
+    size_t* moved = (size_t*)psramRealloc(block, newSize + HEADER);
+    if (!moved) return nullptr;
+    remaining = remaining + oldSize - newSize;
+    *moved = newSize;
+    return (uint8_t*)moved + HEADER;
+  }
+
+ private:
+  static const size_t HEADER = 8;  // Garde l'alignement des blocs
+  size_t remaining;
+};
+
+// ===== ANALYSE =====
+static void dispatch(AsyncWebServerRequest* request, const char* json, size_t len,
+                     const JsonBodyHandler& handler) {
+  BoundedJsonAllocator allocator(max((size_t)JSON_BODY_DOC_MIN, len * JSON_BODY_DOC_RATIO));
+  JsonDocument doc(&allocator);
+  DeserializationError error = deserializeJson(doc, json, len);
+  if (error == DeserializationError::NoMemory) {
+    request->send(413, "application/json", "{\"error\":\"JSON trop volumineux\"}");
+    return;
+  }
+  if (error) {
+    request->send(400, "application/json", "{\"error\":\"JSON invalide\"}");
+    return;
+  }
+  handler(request, doc.as<JsonVariant>());
+}
+
+// Tampon d'assemblage (request->_tempObject, libéré avec la requête)
+struct BodyArena {
+  size_t received;
+  char data[];
+};
+
+// Morceau `index` d'un corps de `total` octets ; `complete` reçoit le corps entier
+static void receiveBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index,
+                        size_t total, size_t maxBody, const BinaryBodyHandler& complete) {
+  if (index == 0) {
+    if (total > maxBody) {
+      request->send(413, "application/json", "{\"error\":\"Requête trop volumineuse\"}");
+      return;
+    }
+    if (len == total) {
+      complete(request, data, len);
+      return;
+    }
+    BodyArena* arena = (BodyArena*)psramMalloc(sizeof(BodyArena) + total);
+    if (!arena) {
+      request->send(503, "application/json", "{\"error\":\"Mémoire insuffisante\"}");
+      return;
+    }
+    arena->received = 0;
+    request->_tempObject = arena;
+  }
+
+  // Morceaux suivants d'un corps refusé, ou hors séquence
+  BodyArena* arena = (BodyArena*)request->_tempObject;
+  if (!arena) return;
+  if (index != arena->received || index + len > total) {
+    psramFree(arena);
+    request->_tempObject = nullptr;
+    request->send(400, "application/json", "{\"error\":\"Corps incomplet\"}");
+    return;
+  }
+
+  memcpy(arena->data + index, data, len);
+  arena->received += len;
+  if (arena->received < total) return;
+
+  complete(request, (const uint8_t*)arena->data, total);
+  psramFree(arena);
+  request->_tempObject = nullptr;
+}
+
+void onJsonBody(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method,
+                JsonBodyHandler handler, size_t maxBody) {
+  server.on(uri, method,
+    // Fin de requête : seuls les cas sans appel du gestionnaire de corps
+    [handler, maxBody](AsyncWebServerRequest *request){
+      if (request->hasParam("body", true)) {
+        const String& body = request->getParam("body", true)->value();
+        if (body.length() > maxBody) {
+          request->send(413, "application/json", "{\"error\":\"Requête trop volumineuse\"}");
+        } else {
+          dispatch(request, body.c_str(), body.length(), handler);
+        }
+      } else if (request->contentLength() == 0) {
+        request->send(400, "application/json", "{\"error\":\"Corps JSON requis\"}");
+      }
+    },
+    NULL,
+    [handler, maxBody](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+      receiveBody(request, data, len, index, total, maxBody,
+        [&handler](AsyncWebServerRequest* request, const uint8_t* body, size_t size) {
+          dispatch(request, (const char*)body, size, handler);
+        });
+    });
+}
+
+void onBinaryBody(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method,
+                  BinaryBodyHandler handler, size_t maxBody) {
+  server.on(uri, method,
+    [](AsyncWebServerRequest *request){
+      if (request->contentLength() == 0) {
+        request->send(400, "application/json", "{\"error\":\"Corps requis\"}");
+      }
+    },
+    NULL,
+    [handler, maxBody](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+      receiveBody(request, data, len, index, total, maxBody, handler);
+    });
+}
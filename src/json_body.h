@@ -0,0 +1,36 @@
+#ifndef JSON_BODY_H
+#define JSON_BODY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <functional>
+
+// ===== CORPS JSON DES REQUÊTES =====
+// Couche commune aux routes POST/PATCH : le corps peut arriver en plusieurs
+// morceaux (index/total) et n'est pas terminé par un zéro.
+//  - corps en un seul morceau (cas courant) : analysé en place, sans copie ;
+//  - en plusieurs morceaux : assemblé dans un tampon PSRAM de `total` octets,
+//    analysé au dernier morceau ;
+//  - `total` au-delà de `maxBody` : 413 dès le premier morceau, rien n'est lu ;
+//  - le document JSON puise dans un budget borné (JSON_BODY_DOC_RATIO fois la
+//    taille du corps) : un JSON pathologique échoue en 413 au lieu d'épuiser
+//    la mémoire.
+// Un corps envoyé en application/x-www-form-urlencoded (curl -d sans
+// en-tête) est repris du paramètre "body" que le serveur en a extrait.
+// onBinaryBody : même assemblage, corps brut (application/octet-stream)
+// remis tel quel au gestionnaire.
+#define JSON_BODY_MAX_DEFAULT  4096
+#define JSON_BODY_MAX_LARGE    32768   // Lots, deltas de synchronisation
+#define JSON_BODY_DOC_RATIO    6
+#define JSON_BODY_DOC_MIN      4096
+
+typedef std::function<void(AsyncWebServerRequest*, JsonVariant)> JsonBodyHandler;
+typedef std::function<void(AsyncWebServerRequest*, const uint8_t*, size_t)> BinaryBodyHandler;
+
+void onJsonBody(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method,
+                JsonBodyHandler handler, size_t maxBody = JSON_BODY_MAX_DEFAULT);
+void onBinaryBody(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method,
+                  BinaryBodyHandler handler, size_t maxBody);
+
+#endif
@@ -0,0 +1,69 @@
+#include "keypad.h"
+
+// Nombre de chaînes de chiffres de longueur < n : (10^n - 1) / 9
+static uint32_t shorterCount(uint8_t n) {
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < n; i++) count = count * 10 + 1;
+  return count;
+}
+
+static uint64_t powerOfTen(uint8_t n) {
+  uint64_t p = 1;
+  while (n--) p *= 10;
+  return p;
+}
+
+void KeypadEntry::push(uint8_t digit) {
+  if (length >= KEYPAD_MAX_DIGITS) {
+    overflow = true;
+    return;
+  }
+  digits[length++] = digit;
+  value = value * 10 + digit;
+}
+
+bool KeypadEntry::key(uint32_t& out) const {
+  if (length == 0 || overflow) return false;
+
+  if (digits[0] != 0) {
+    if (value > 0x7FFFFFFF) return false;
+    out = (uint32_t)value;
+    return true;
+  }
+
+  // Zéro initial : rang des (length - 1) chiffres suivants parmi toutes les
+  // chaînes plus courtes puis de même longueur (< 2^31 jusqu'à 10 chiffres)
+  uint8_t rest = length - 1;
+  out = KEYPAD_PIN_FLAG | (shorterCount(rest) + (uint32_t)value);
+  return true;
+}
+
+bool keypadKeyFromText(const char* pin, uint32_t& key) {
+  if (!pin) return false;
+  KeypadEntry entry;
+  entry.clear();
+  for (const char* c = pin; *c; c++) {
+    if (*c < '0' || *c > '9') return false;
+    entry.push(*c - '0');
+  }
+  return entry.key(key);
+}
+
+void keypadKeyToText(uint32_t key, char* out, size_t size) {
+  if (!(key & KEYPAD_PIN_FLAG)) {
+    snprintf(out, size, "%lu", (unsigned long)key);
+    return;
+  }
+
+  uint32_t rank = key & ~KEYPAD_PIN_FLAG;
+  uint8_t rest = 0;
+  while (rest + 1 < KEYPAD_MAX_DIGITS && shorterCount(rest + 1) <= rank) rest++;
+  uint64_t value = rank - shorterCount(rest);
+  if (rest == 0) {
+    snprintf(out, size, "0");
+    return;
+  }
+  // Rang hors plage (clé forgée) : tronqué aux `rest` chiffres de poids faible
+  value %= powerOfTen(rest);
+  snprintf(out, size, "0%0*llu", rest, (unsigned long long)value);
+}
@@ -0,0 +1,40 @@
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include <Arduino.h>
+
+// ===== SAISIE CLAVIER =====
+// Accumulateur de chiffres à taille fixe (aucune allocation par touche) et
+// clé 32 bits calculée au fil de la saisie, comparée telle quelle à
+// AccessCode.code :
+//  - PIN sans zéro initial tenant sur 31 bits : clé = valeur décimale
+//    (identique aux codes clavier déjà enregistrés), donc 2147483647 au
+//    plus : un PIN de 10 chiffres au-delà est refusé ;
+//  - PIN commençant par 0 : bit 31 à 1 et rang du PIN parmi les PIN de même
+//    préfixe, longueur comprise, donc "0123" != "123" != "00123".
+// Au-delà de KEYPAD_MAX_DIGITS chiffres, ou si la valeur ne tient pas sur la
+// clé, la saisie est refusée à la validation au lieu d'être tronquée.
+// L'ancien clavier ignorait les zéros initiaux ("0123" enregistré 123) : voir
+// les PIN "pinLegacy" de main.cpp.
+#define KEYPAD_MAX_DIGITS  10
+#define KEYPAD_PIN_FLAG    0x80000000u
+
+struct KeypadEntry {
+  uint8_t digits[KEYPAD_MAX_DIGITS];
+  uint8_t length;
+  bool overflow;       // Chiffres tapés au-delà de la capacité
+  uint64_t value;      // Valeur décimale des chiffres saisis
+  unsigned long lastInput;
+
+  void clear() { length = 0; overflow = false; value = 0; }
+  bool empty() const { return length == 0 && !overflow; }
+  void push(uint8_t digit);
+  bool key(uint32_t& out) const;  // Faux si la saisie n'est pas représentable
+};
+
+// PIN texte ("0123") -> clé ; faux si vide, non numérique ou trop long
+bool keypadKeyFromText(const char* pin, uint32_t& key);
+// Clé -> PIN texte, zéros initiaux compris (out : KEYPAD_MAX_DIGITS + 1)
+void keypadKeyToText(uint32_t key, char* out, size_t size);
+
+#endif
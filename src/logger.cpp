@@ -0,0 +1,144 @@
+#include "logger.h"
+
+// Anneau multi-producteurs sans verrou : chaque écrivain réserve un index
+// avec fetch_add, remplit la case puis publie `seq = index + 1`. Les
+// lecteurs (tâche d'affichage, /api/debuglog) copient la case et vérifient
+// que `seq` n'a pas bougé pendant la copie.
+struct LogSlot {
+  std::atomic<uint32_t> seq;
+  LogEntry entry;
+};
+
+static LogSlot logRing[LOG_RING_SIZE];
+static std::atomic<uint32_t> logHead(0);
+static std::atomic<uint32_t> logTail(0);
+static std::atomic<uint32_t> logDropped(0);
+
+std::atomic<uint8_t> logRuntimeLevel(LOG_LEVEL);
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of 2");
+
+void logCommit(const LogEntry& entry) {
+  uint32_t index = logHead.fetch_add(1, std::memory_order_relaxed);
+  LogSlot& slot = logRing[index & (LOG_RING_SIZE - 1)];
+
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.entry = entry;
+  slot.seq.store(index + 1, std::memory_order_release);
+}
+
+// 1 = lu, 0 = écriture en cours, -1 = entrée déjà écrasée
+static int logTryRead(uint32_t index, LogEntry& out) {
+  LogSlot& slot = logRing[index & (LOG_RING_SIZE - 1)];
+
+  uint32_t before = slot.seq.load(std::memory_order_acquire);
+  if (before == 0) return 0;
+  if (before != index + 1) return (int32_t)(before - (index + 1)) > 0 ? -1 : 0;
+
+  out = slot.entry;
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  return slot.seq.load(std::memory_order_relaxed) == before ? 1 : -1;
+}
+
+bool logReadEntry(uint32_t index, LogEntry& out) {
+  return logTryRead(index, out) == 1;
+}
+
+uint32_t logHeadIndex() {
+  return logHead.load(std::memory_order_acquire);
+}
+
+uint32_t logDroppedCount() {
+  return logDropped.load(std::memory_order_relaxed);
+}
+
+void logSetLevel(uint8_t level) {
+  if (level > LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+  logRuntimeLevel.store(level, std::memory_order_relaxed);
+}
+
+char logLevelChar(uint8_t level) {
+  switch (level) {
+    case LOG_LEVEL_ERROR: return 'E';
+    case LOG_LEVEL_WARN:  return 'W';
+    case LOG_LEVEL_INFO:  return 'I';
+    case LOG_LEVEL_DEBUG: return 'D';
+    default:              return '?';
+  }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+size_t logFormat(const LogEntry& entry, char* out, size_t len) {
+  uintptr_t a[LOG_MAX_ARGS] = {0};
+  for (uint8_t i = 0; i < entry.argc; i++) {
+    a[i] = (entry.strMask & (1u << i)) ? (uintptr_t)(entry.strings + entry.args[i])
+                                       : entry.args[i];
+  }
+
+  int n = snprintf(out, len, entry.fmt, a[0], a[1], a[2], a[3], a[4], a[5]);
+  if (n < 0) n = 0;
+  if ((size_t)n >= len) n = len - 1;
+
+  // Les messages n'ont pas de retour à la ligne : c'est l'affichage qui l'ajoute
+  while (n > 0 && (out[n - 1] == '\n' || out[n - 1] == '\r')) out[--n] = '\0';
+  return n;
+}
+#pragma GCC diagnostic pop
+
+// ===== TÂCHE D'AFFICHAGE =====
+static void logDrain() {
+  char line[192];
+  uint32_t head = logHead.load(std::memory_order_acquire);
+  uint32_t tail = logTail.load(std::memory_order_relaxed);
+
+  // La tâche a pris trop de retard : les plus anciennes entrées sont perdues
+  if (head - tail > LOG_RING_SIZE) {
+    logDropped.fetch_add(head - tail - LOG_RING_SIZE, std::memory_order_relaxed);
+    tail = head - LOG_RING_SIZE;
+  }
+
+  while (tail != head) {
+    LogEntry entry;
+    int rc = logTryRead(tail, entry);
+    if (rc == 0) break;  // Écrivain encore en cours, on reviendra
+
+    if (rc > 0) {
+      int n = snprintf(line, sizeof(line), "[%7lu] %c ",
+                       (unsigned long)entry.timestamp, logLevelChar(entry.level));
+      logFormat(entry, line + n, sizeof(line) - n);
+      Serial.println(line);
+    } else {
+      logDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    tail++;
+  }
+
+  logTail.store(tail, std::memory_order_release);
+}
+
+static void logDrainTask(void* arg) {
+  for (;;) {
+    logDrain();
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+}
+
+void logBegin() {
+  // Priorité la plus basse au-dessus de idle : l'affichage ne passe jamais
+  // devant le contrôle d'accès
+  xTaskCreatePinnedToCore(logDrainTask, "logDrain", 3072, NULL,
+                          tskIDLE_PRIORITY + 1, NULL, 0);
+}
+
+// Attendre que la tâche ait tout affiché (avant un redémarrage par exemple)
+void logFlush(uint32_t timeoutMs) {
+  unsigned long start = millis();
+  while (logTail.load(std::memory_order_acquire) != logHead.load(std::memory_order_acquire) &&
+         millis() - start < timeoutMs) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
@@ -0,0 +1,134 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// ===== NIVEAUX DE LOG =====
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+
+// Niveau de compilation (build_flags -DLOG_LEVEL=n) : les appels au-dessus
+// de ce niveau ne génèrent aucun code.
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_SIZE     64   // Entrées conservées (puissance de 2)
+#define LOG_MAX_ARGS      6    // Arguments capturés par message
+#define LOG_STR_BYTES     48   // Espace pour copier les arguments %s
+
+// Une entrée brute : le format n'est appliqué que par la tâche d'affichage
+// ou par /api/debuglog. `fmt` doit être un littéral.
+struct LogEntry {
+  uint32_t timestamp;
+  const char* fmt;
+  uint8_t level;
+  uint8_t argc;
+  uint8_t strMask;              // Bit i : args[i] est un offset dans strings[]
+  uintptr_t args[LOG_MAX_ARGS];
+  char strings[LOG_STR_BYTES];
+};
+
+extern std::atomic<uint8_t> logRuntimeLevel;
+
+void logBegin();
+void logCommit(const LogEntry& entry);
+void logFlush(uint32_t timeoutMs);
+void logSetLevel(uint8_t level);
+uint32_t logHeadIndex();
+uint32_t logDroppedCount();
+bool logReadEntry(uint32_t index, LogEntry& out);
+size_t logFormat(const LogEntry& entry, char* out, size_t len);
+char logLevelChar(uint8_t level);
+
+// ===== CAPTURE DES ARGUMENTS =====
+namespace logdetail {
+
+struct Packer {
+  LogEntry& entry;
+  uint8_t strUsed;
+};
+
+inline void packOne(Packer& p, const char* s) {
+  if (p.entry.argc >= LOG_MAX_ARGS) return;
+  if (s == nullptr) s = "(null)";
+
+  size_t room = LOG_STR_BYTES - p.strUsed;
+  if (room < 2) {
+    p.entry.args[p.entry.argc++] = (uintptr_t)"...";  // Littéral statique
+    return;
+  }
+
+  size_t n = strnlen(s, room - 1);
+  memcpy(p.entry.strings + p.strUsed, s, n);
+  p.entry.strings[p.strUsed + n] = '\0';
+  p.entry.strMask |= (uint8_t)(1u << p.entry.argc);
+  p.entry.args[p.entry.argc++] = p.strUsed;
+  p.strUsed += n + 1;
+}
+
+inline void packOne(Packer& p, char* s) { packOne(p, (const char*)s); }
+inline void packOne(Packer& p, const String& s) { packOne(p, s.c_str()); }
+
+template <typename T>
+inline void packOne(Packer& p, T v) {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "LOG_*: only integer and string arguments are supported");
+  if (p.entry.argc < LOG_MAX_ARGS) p.entry.args[p.entry.argc++] = (uintptr_t)v;
+}
+
+}  // namespace logdetail
+
+template <typename... Args>
+void logPush(uint8_t level, const char* fmt, Args... args) {
+  LogEntry entry;
+  entry.timestamp = millis();
+  entry.fmt = fmt;
+  entry.level = level;
+  entry.argc = 0;
+  entry.strMask = 0;
+
+  logdetail::Packer packer{entry, 0};
+  int expand[] = {0, (logdetail::packOne(packer, args), 0)...};
+  (void)expand;
+  (void)packer;
+
+  logCommit(entry);
+}
+
+#define LOG_AT(lvl, fmt, ...)                                              \
+  do {                                                                     \
+    if ((lvl) <= logRuntimeLevel.load(std::memory_order_relaxed))          \
+      logPush((lvl), fmt, ##__VA_ARGS__);                                  \
+  } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do {} while (0)
+#endif
+
+#endif
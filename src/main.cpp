@@ -6,14 +6,34 @@
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
-#include <Wiegand.h>
+#include <nvs.h>
+#include <rom/crc.h>
 #include "config.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include "name_pool.h"
+#include "schedule.h"
+#include "groups.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "switches.h"
+#include "boot.h"
+#include "network.h"
+#include "events.h"
+#include "scheduler.h"
+#include "readers.h"
+#include "keypad.h"
+#include "admission.h"
+#include "auth.h"
+#include "code_index.h"
+#include "stats.h"
+#include "metrics.h"
+#include "snapshot.h"
 
 // Bouton pour reset WiFi (bouton BOOT sur ESP32)
 #define RESET_WIFI_BUTTON 0
 
 // ===== OBJETS GLOBAUX =====
-WIEGAND wg;
 AsyncWebServer server(80);
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
@@ -21,18 +41,27 @@ Preferences preferences;
 WiFiManager wifiManager;
 
 Config config;
-AccessCode accessCodes[50];  // Max 50 codes
-AccessLog accessLogs[100];   // Max 100 logs
+AccessCode* accessCodes = nullptr;  // Alloués en PSRAM si disponible
+uint32_t* accessCodeNames = nullptr; // Référence de chaque nom dans le pool
+uint16_t* accessCodeGroups = nullptr; // Appartenance aux groupes (bitset)
+AccessLog* accessLogs = nullptr;
+int accessCodeCapacity = 0;
+int accessLogCapacity = 0;
 int accessCodeCount = 0;
+uint32_t codeTableVersion = 0;  // Incrémentée à chaque écriture de la table
 int logIndex = 0;
 
-unsigned long relayStartTime = 0;
-bool relayActive = false;
 unsigned long lastMqttReconnect = 0;
+// Chaque tentative MQTT bloque loop() quelques secondes au plus (délais de
+// setupMQTT()) : délai doublé à chaque échec pour qu'un broker absent ne
+// ralentisse pas le contrôle d'accès
+const unsigned long MQTT_RETRY_MIN = 5000;
+const unsigned long MQTT_RETRY_MAX = 120000;
+unsigned long mqttRetryDelay = MQTT_RETRY_MIN;
+const unsigned long MQTT_POLL_MS = 20;
 
-// Variables pour accumulation des codes numériques
-String keypadBuffer = "";
-unsigned long lastKeypadInput = 0;
+// Saisie des codes numériques (une par lecteur, sans allocation)
+KeypadEntry keypadEntries[MAX_READERS];
 const unsigned long KEYPAD_TIMEOUT = 10000;  // 10 secondes
 
 // Variables pour mode apprentissage (learning mode)
@@ -42,249 +71,253 @@ const unsigned long LEARNING_TIMEOUT = 60000;  // 60 secondes
 uint8_t learningType = 0;  // 0=Keypad, 1=RFID, 2=Fingerprint
 String learningName = "";
 
+// Apprentissage par lot : les identifiants restent en RAM jusqu'à la fin de
+// la session, puis un seul saveAccessCodes()
+const unsigned long LEARNING_BATCH_TIMEOUT = 600000;  // 10 minutes par défaut
+const uint16_t LEARNING_BATCH_MAX = 1000;
+bool learningBatch = false;
+unsigned long learningDuration = LEARNING_TIMEOUT;
+uint16_t learningTarget = 0;    // 0 = jusqu'au timeout
+uint16_t learningEnrolled = 0;
+uint16_t learningNumber = 1;    // Prochain numéro du modèle de nom
+
 // ===== PROTOTYPES =====
 void loadConfig();
-void saveConfig();
+size_t saveConfig(int* changedFields = nullptr);
+void revertConfig();
+void allocateTables();
 void loadAccessCodes();
-void saveAccessCodes();
-void addAccessLog(uint32_t code, bool granted, uint8_t type);
-bool checkAccessCode(uint32_t code, uint8_t type);
-void activateRelay(bool open);
-void deactivateRelay();
+bool saveAccessCodes();
+bool commitAccessCodes(uint32_t version);
+bool insertAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule,
+                      uint16_t groups);
+void eraseAccessCodeAt(int index);
+const char* accessCodeName(int index);
+void addAccessLog(uint32_t code, bool granted, uint8_t type, uint8_t reader = 0, bool known = true);
+bool checkAccessCode(uint32_t code, uint8_t type, bool* known = nullptr);
 void handleWiegandInput();
+void handleMQTT();
+void handleWiegandFrame(uint8_t reader, uint32_t code, uint8_t bitCount);
+bool processCredential(uint8_t reader, uint32_t code, uint8_t type, uint8_t bitCount);
 bool checkTriplePress();
-void blinkReaderLED(bool success);
-void processKeypadCode();
-bool addNewAccessCode(uint32_t code, uint8_t type, const char* name);
+void processKeypadCode(uint8_t reader);
+bool addNewAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule = 0,
+                      uint16_t groups = GROUP_DEFAULT_MASK);
+bool setAccessCodeSchedule(uint32_t code, uint8_t type, uint8_t schedule);
+bool setAccessCodeGroups(uint32_t code, uint8_t type, uint16_t groups);
 bool removeAccessCode(uint32_t code, uint8_t type);
 bool deleteAccessCode(int index);
 void startLearningMode(uint8_t type, const char* name);
+bool startBatchLearning(uint8_t type, const char* nameTemplate, uint16_t count,
+                        unsigned long timeoutMs, uint16_t firstNumber);
+void learnCredential(uint8_t reader, uint32_t code, uint8_t type);
 void stopLearningMode();
 
 // Fonctions externes (définies dans d'autres fichiers)
-void setupWebServer();
-void setupMQTT();
 void reconnectMQTT();
-void publishMQTT(const char* topic, const char* payload);
+void mqttApplySnapshot();
+bool publishMQTT(const char* topic, const char* payload);
 
 // ===== FONCTION RESET WiFi =====
-// Fonction pour détecter 3 appuis sur le bouton BOOT
+// 3 appuis sur le bouton BOOT dans les 10 secondes suivant le démarrage.
+// Comptés par interruption : le démarrage n'attend plus la fin de la fenêtre.
+#define WIFI_RESET_WINDOW_MS  10000
+#define WIFI_RESET_DEBOUNCE_MS  50
+
+static volatile uint8_t resetPressCount = 0;
+static volatile uint32_t lastResetEdge = 0;
+
+void IRAM_ATTR onResetButton() {
+  uint32_t now = millis();
+  if (now - lastResetEdge >= WIFI_RESET_DEBOUNCE_MS && now < WIFI_RESET_WINDOW_MS) {
+    resetPressCount++;
+  }
+  lastResetEdge = now;
+  schedulerPostFromISR(EVENT_RESET_BUTTON);
+}
+
+// Appelée par loop() : vrai une seule fois si le triple appui est détecté
 bool checkTriplePress() {
-  int pressCount = 0;
-  unsigned long startTime = millis();
-  unsigned long lastPressTime = 0;
-  bool lastState = HIGH;
-  
-  Serial.println("\n⏱ WiFi Reset Check (10 seconds window)...");
-  Serial.println("Press BOOT button 3 times to reset WiFi credentials");
+  static bool armed = true;
+  static uint8_t reported = 0;
+  if (!armed) return false;
+  
+  uint8_t pressCount = resetPressCount;
+  if (pressCount != reported) {
+    reported = pressCount;
+    LOG_I("✓ Press %d/3 detected", pressCount);
+  }
   
-  while (millis() - startTime < 10000) {  // 10 secondes
-    bool currentState = digitalRead(RESET_WIFI_BUTTON);
-    
-    // Détection front descendant (appui)
-    if (lastState == HIGH && currentState == LOW) {
-      pressCount++;
-      lastPressTime = millis();
-      Serial.printf("✓ Press %d/3 detected\n", pressCount);
-      
-      if (pressCount >= 3) {
-        Serial.println("\n🔥 Triple press detected!");
-        return true;
-      }
-      
-      delay(50);  // Anti-rebond
-    }
-    
-    lastState = currentState;
-    delay(10);
+  if (pressCount >= 3) {
+    armed = false;
+    detachInterrupt(digitalPinToInterrupt(RESET_WIFI_BUTTON));
+    LOG_W("🔥 Triple press detected!");
+    return true;
   }
   
-  if (pressCount > 0) {
-    Serial.printf("Only %d press(es) detected. Reset cancelled.\n", pressCount);
+  if (millis() >= WIFI_RESET_WINDOW_MS) {
+    armed = false;
+    detachInterrupt(digitalPinToInterrupt(RESET_WIFI_BUTTON));
+    if (pressCount > 0) {
+      LOG_I("Only %d press(es) detected. Reset cancelled.", pressCount);
+    }
+    LOG_I("No reset requested. Continuing...");
   }
-  Serial.println("No reset requested. Continuing...\n");
   return false;
 }
 
 // ===== SETUP =====
+// Contrôle d'accès d'abord (relais, table des codes, lecteurs) : une porte
+// reste utilisable quelques millisecondes après une coupure de courant.
+// Le WiFi démarre ensuite en arrière-plan (network.cpp).
 void setup() {
   Serial.begin(115200);
-  delay(1000);  // Attendre la stabilisation du port série
+  schedulerBegin();  // Avant toute interruption : elles réveillent loop()
+  logBegin();   // Tâche d'affichage des logs (basse priorité)
   
-  Serial.println("\n\n=== ESP32 Roller Shutter Controller ===");
-  Serial.println("Version 1.0 - With Wiegand, RFID & Fingerprint");
-  Serial.println("Chip ID: " + String((uint32_t)ESP.getEfuseMac(), HEX));
-  Serial.println("SDK Version: " + String(ESP.getSdkVersion()));
-  
-  // Configuration des pins
-  pinMode(RELAY_OPEN, OUTPUT);
-  pinMode(RELAY_CLOSE, OUTPUT);
-  pinMode(PHOTO_BARRIER, INPUT_PULLUP);
+  // Relais coupés le plus tôt possible (relais, barrières de chaque porte)
+  doorsBegin();
   pinMode(STATUS_LED, OUTPUT);
-  pinMode(RESET_WIFI_BUTTON, INPUT_PULLUP);
-  pinMode(READER_LED_RED, OUTPUT);
-  pinMode(READER_LED_GREEN, OUTPUT);
-  
-  digitalWrite(RELAY_OPEN, LOW);
-  digitalWrite(RELAY_CLOSE, LOW);
   digitalWrite(STATUS_LED, LOW);
-  digitalWrite(READER_LED_RED, LOW);
-  digitalWrite(READER_LED_GREEN, LOW);
-
-    // Initialisation des interrupteurs manuels
-  pinMode(PIN_UP_SWITCH, INPUT_PULLUP);
-  pinMode(PIN_DOWN_SWITCH, INPUT_PULLUP);
-  
-  // ===== CONFIGURATION WiFi EN PREMIER =====
-  // Configuration WiFiManager (AVANT les paramètres WiFi)
-  wifiManager.setConfigPortalTimeout(180);  // 3 minutes pour configurer
-  wifiManager.setConnectTimeout(30);        // 30 secondes pour se connecter
-  wifiManager.setConnectRetries(3);         // 3 tentatives de connexion
-  wifiManager.setDebugOutput(true);         // Activer le debug
-  
-  // Vérifier triple appui pour reset WiFi
-  if (checkTriplePress()) {
-    Serial.println("\n⚠⚠⚠ RESETTING WiFi credentials ⚠⚠⚠");
-    wifiManager.resetSettings();
-    delay(1000);
-    Serial.println("Credentials erased. Restarting...");
-    delay(2000);
-    ESP.restart();
-  }
-  
-  // Tentative de connexion WiFi
-  Serial.println("\n⏱ Starting WiFi configuration...");
-  Serial.println("If no saved credentials, access point will start:");
-  Serial.println("SSID: ESP32-Roller-Setup");
-  Serial.println("No password required");
-  Serial.println("Connect and configure WiFi at: http://192.168.4.1\n");
-  
-  // Configuration WiFi pour compatibilité Freebox (juste avant autoConnect)
-  WiFi.setTxPower(WIFI_POWER_19_5dBm);  // Réduire la puissance pour éviter les timeouts
-  WiFi.setAutoReconnect(true);
-  WiFi.persistent(true);
-  
-  digitalWrite(STATUS_LED, HIGH);
-  
-  if (!wifiManager.autoConnect("ESP32-Roller-Setup")) {
-    Serial.println("\n✗✗✗ WiFiManager failed to connect ✗✗✗");
-    Serial.println("Restarting in 5 seconds...");
-    digitalWrite(STATUS_LED, LOW);
-    delay(5000);
-    ESP.restart();
-  }
-  
-  // Connexion réussie
-  Serial.println("\n✓✓✓ WiFi CONNECTED ✓✓✓");
-  Serial.print("IP Address: ");
-  Serial.println(WiFi.localIP());
-  Serial.print("Gateway: ");
-  Serial.println(WiFi.gatewayIP());
-  Serial.print("RSSI: ");
-  Serial.print(WiFi.RSSI());
-  Serial.println(" dBm");
-  digitalWrite(STATUS_LED, LOW);
-  
-  // Arrêter le serveur de configuration WiFiManager pour libérer le port 80
-  wifiManager.stopConfigPortal();
-  delay(500);  // Attendre la libération du port
+  bootMark("relays");
   
-  // ===== INITIALISATION DES AUTRES COMPOSANTS =====
-  // Initialisation Wiegand
-  wg.begin(WIEGAND_D0, WIEGAND_D1);
-  Serial.println("✓ Wiegand initialized on pins 32 & 33");
+  LOG_I("=== ESP32 Roller Shutter Controller ===");
+  LOG_I("Version 1.0 - With Wiegand, RFID & Fingerprint");
+  LOG_I("Chip ID: %X", (uint32_t)ESP.getEfuseMac());
+  LOG_I("SDK Version: %s", ESP.getSdkVersion());
   
   // Chargement de la configuration
-  preferences.begin("roller", false);
+  snapshotBegin();  // Espace NVS actif (restauration interrompue)
+  preferences.begin(stateNamespace(), false);
   loadConfig();
+  authBegin();
+  loadDoors();
+  loadMetrics();
+  bootMark("config");
+  
+  // Table des codes en cache local
+  allocateTables();
   loadAccessCodes();
+  loadSchedules();
+  loadGroups();
+  statsBegin(accessCodeCapacity);
+  bootMark("codes");
   
-  // Configuration serveur web
-  setupWebServer();
-  
-  // Configuration MQTT
-  setupMQTT();
-  
-  // Démarrage du serveur
-  server.begin();
-  Serial.println("✓ Web server started");
-  Serial.println("\n========================================");
-  Serial.println("Access the web interface at:");
-  Serial.print("http://");
-  Serial.println(WiFi.localIP());
-  Serial.println("========================================\n");
-  
-  // Clignotement de confirmation
-  for(int i=0; i<3; i++) {
-    digitalWrite(STATUS_LED, HIGH);
-    delay(200);
-    digitalWrite(STATUS_LED, LOW);
-    delay(200);
-  }
-}
-
-void handleManualSwitches() {
-  static unsigned long lastPressTime = 0;
-  unsigned long debounceDelay = 200; // 200ms pour éviter les rebonds/répétitions
-
-  if (millis() - lastPressTime > debounceDelay) {
-    if (digitalRead(PIN_UP_SWITCH) == LOW) {
-      Serial.println("Manual switch: OPEN");
-      activateRelay(true);
-      lastPressTime = millis();
-    } else if (digitalRead(PIN_DOWN_SWITCH) == LOW) {
-      Serial.println("Manual switch: CLOSE");
-      activateRelay(false);
-      lastPressTime = millis();
-    }
-  }
+  // Lecteurs Wiegand et interrupteurs (interruptions sur le cœur de loop())
+  readersBegin();
+  switchesBegin();
+  bootMark("access");
+  
+  // Triple appui BOOT pour reset WiFi, détecté en arrière-plan par loop()
+  pinMode(RESET_WIFI_BUTTON, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(RESET_WIFI_BUTTON), onResetButton, FALLING);
+  LOG_I("Press BOOT button 3 times within 10 s to reset WiFi credentials");
+  timerArm(TIMER_RESET_WINDOW, WIFI_RESET_WINDOW_MS);
+  timerArm(TIMER_HOUSEKEEPING, SCHEDULER_HOUSEKEEPING_MS);
+  
+  // WiFi, puis serveur web et MQTT dès que la connexion est établie
+  networkBegin();
 }
 
 // ===== LOOP =====
 void loop() {
-  // Vérification connexion WiFi
-  static unsigned long lastWiFiCheck = 0;
-  if (millis() - lastWiFiCheck > 30000) {  // Toutes les 30 secondes
-    lastWiFiCheck = millis();
-    if (WiFi.status() != WL_CONNECTED) {
-      Serial.println("⚠ WiFi disconnected! Reconnecting...");
-      WiFi.reconnect();
+  // Sommeil jusqu'à la prochaine échéance ou au prochain événement
+  SchedulerWake wake = schedulerWait();
+  bool housekeeping = wake.fired(TIMER_HOUSEKEEPING);
+  if (housekeeping) timerArm(TIMER_HOUSEKEEPING, SCHEDULER_HOUSEKEEPING_MS);
+  
+  // Reset WiFi demandé au démarrage
+  if (housekeeping || (wake.events & EVENT_RESET_BUTTON) || wake.fired(TIMER_RESET_WINDOW)) {
+    if (checkTriplePress()) {
+      LOG_W("⚠⚠⚠ RESETTING WiFi credentials ⚠⚠⚠");
+      wifiManager.resetSettings();
+      LOG_W("Credentials erased. Restarting...");
+      logFlush(2000);
+      ESP.restart();
     }
   }
   
-  // Gestion Wiegand
-  handleWiegandInput();
+  // Serveur web et MQTT au premier passage après la connexion WiFi
+  if (housekeeping || (wake.events & EVENT_NETWORK)) networkUpdate();
+  
+  // Appel du serveur web (table des codes) : loop() seule y touche
+  if (wake.events & EVENT_CALL) schedulerRunCall();
   
-  // Gestion relais avec temporisation
-  if (relayActive && (millis() - relayStartTime >= config.relayDuration)) {
-    deactivateRelay();
+  // Gestion Wiegand
+  if (housekeeping || (wake.events & EVENT_READERS) || wake.fired(TIMER_READERS)) {
+    handleWiegandInput();
   }
   
-  // Vérification barrière photoélectrique
-  if (config.photoBarrierEnabled && relayActive) {
-    if (digitalRead(PHOTO_BARRIER) == LOW) {  // Barrière coupée
-      Serial.println("⚠ Photo barrier triggered! Stopping relay.");
-      deactivateRelay();
-      publishMQTT("status", "{\"event\":\"barrier_triggered\"}");
-    }
+  // Portes : événements des interrupteurs, commandes en file (web, MQTT,
+  // badges, interrupteurs) puis temporisation des relais et barrières
+  if (housekeeping || (wake.events & EVENT_SWITCHES) || wake.fired(TIMER_SWITCHES)) {
+    switchesUpdate();
+  }
+  bool doorCommands = wake.events & EVENT_DOOR_COMMAND;
+  if (housekeeping || doorCommands) doorCommandsUpdate();
+  if (housekeeping || doorCommands || wake.fired(TIMER_DOORS)) doorsUpdate();
+  
+  // Sauvegarde périodique des statistiques et compteurs moteur
+  if (housekeeping) {
+    statsLoop();
+    metricsLoop();
   }
   
-  // Reconnexion MQTT si nécessaire
-  if (!mqttClient.connected() && millis() - lastMqttReconnect > 5000) {
+  if (housekeeping || wake.fired(TIMER_MQTT)) handleMQTT();
+}
+
+// Reconnexion, réception et événements différés. Le client MQTT n'a pas
+// d'interruption : interrogé toutes les MQTT_POLL_MS tant qu'il est connecté.
+void handleMQTT() {
+  if (networkServicesStarted() && networkConnected() && !mqttClient.connected() &&
+      millis() - lastMqttReconnect > mqttRetryDelay) {
     reconnectMQTT();
     lastMqttReconnect = millis();
+    mqttRetryDelay = mqttClient.connected() ? MQTT_RETRY_MIN : min(mqttRetryDelay * 2, MQTT_RETRY_MAX);
   }
   
   if (mqttClient.connected()) {
     mqttClient.loop();
+    mqttApplySnapshot();  // Instantané reçu complet, appliqué hors du callback
+    eventsFlush();  // Événements gardés pendant la coupure
+    timerArm(TIMER_MQTT, MQTT_POLL_MS);
+  } else if (networkServicesStarted() && networkConnected()) {
+    timerArm(TIMER_MQTT, mqttRetryDelay - min(millis() - lastMqttReconnect, mqttRetryDelay));
   }
-  
-  handleManualSwitches(); // Ajouter l'appel à la nouvelle fonction
-  
-  delay(10);
+  // Sinon : TIMER_HOUSEKEEPING revérifie chaque seconde
 }
 
 // ===== FONCTIONS CONFIGURATION =====
+// Description des champs persistés : clé NVS, type et position dans Config
+enum ConfigFieldKind : uint8_t { CFG_U32, CFG_I32, CFG_U16, CFG_BOOL, CFG_STR };
+
+struct ConfigFieldDesc {
+  const char* key;
+  ConfigFieldKind kind;
+  size_t offset;
+  size_t size;
+};
+
+#define CONFIG_FIELD(key, kind, member) \
+  { key, kind, offsetof(Config, member), sizeof(((Config*)0)->member) }
+
+static const ConfigFieldDesc configFields[] = {
+  CONFIG_FIELD("relayDur", CFG_U32,  relayDuration),
+  CONFIG_FIELD("photoEn",  CFG_BOOL, photoBarrierEnabled),
+  CONFIG_FIELD("mqttPort", CFG_I32,  mqttPort),
+  CONFIG_FIELD("mqttSrv",  CFG_STR,  mqttServer),
+  CONFIG_FIELD("mqttUser", CFG_STR,  mqttUser),
+  CONFIG_FIELD("mqttPass", CFG_STR,  mqttPassword),
+  CONFIG_FIELD("mqttTop",  CFG_STR,  mqttTopic),
+  CONFIG_FIELD("adminPw",  CFG_STR,  adminPassword),
+  CONFIG_FIELD("tz",       CFG_STR,  timezone),
+  CONFIG_FIELD("maxCodes", CFG_U16,  maxCodes),
+  CONFIG_FIELD("maxLogs",  CFG_U16,  maxLogs),
+  CONFIG_FIELD("init",     CFG_BOOL, initialized),
+};
+
+static Config persistedConfig;  // Contenu actuel de la flash
+
 void loadConfig() {
   config.relayDuration = preferences.getULong("relayDur", 5000);
   config.photoBarrierEnabled = preferences.getBool("photoEn", true);
@@ -299,379 +332,772 @@ void loadConfig() {
   if (strlen(config.mqttTopic) == 0) strcpy(config.mqttTopic, "roller");
   if (strlen(config.adminPassword) == 0) strcpy(config.adminPassword, "admin");
   
+  preferences.getString("tz", config.timezone, sizeof(config.timezone));
+  if (strlen(config.timezone) == 0) strcpy(config.timezone, "CET-1CEST,M3.5.0,M10.5.0/3");
+  
+  config.maxCodes = preferences.getUShort("maxCodes", 0);
+  config.maxLogs = preferences.getUShort("maxLogs", 0);
+  
   config.initialized = preferences.getBool("init", false);
   
-  Serial.printf("✓ Config loaded: Relay=%lums, MQTT=%s:%d\n", 
-                config.relayDuration, config.mqttServer, config.mqttPort);
+  persistedConfig = config;
+  
+  LOG_I("✓ Config loaded: Relay=%lums, MQTT=%s:%d", 
+        config.relayDuration, config.mqttServer, config.mqttPort);
+}
+
+// Taille occupée en NVS : une entrée de 32 octets, plus les données des chaînes
+static size_t configFieldFlashBytes(const ConfigFieldDesc& field) {
+  if (field.kind != CFG_STR) return 32;
+  size_t len = strlen((const char*)&config + field.offset) + 1;
+  return 32 + (len + 31) / 32 * 32;
+}
+
+static bool configFieldChanged(const ConfigFieldDesc& field) {
+  const uint8_t* current = (const uint8_t*)&config + field.offset;
+  const uint8_t* stored = (const uint8_t*)&persistedConfig + field.offset;
+  if (field.kind == CFG_STR) return strcmp((const char*)current, (const char*)stored) != 0;
+  return memcmp(current, stored, field.size) != 0;
 }
 
-void saveConfig() {
-  preferences.putULong("relayDur", config.relayDuration);
-  preferences.putBool("photoEn", config.photoBarrierEnabled);
-  preferences.putInt("mqttPort", config.mqttPort);
-  preferences.putString("mqttSrv", config.mqttServer);
-  preferences.putString("mqttUser", config.mqttUser);
-  preferences.putString("mqttPass", config.mqttPassword);
-  preferences.putString("mqttTop", config.mqttTopic);
-  preferences.putString("adminPw", config.adminPassword);
-  preferences.putBool("init", true);
+static esp_err_t writeConfigField(nvs_handle_t handle, const ConfigFieldDesc& field) {
+  const uint8_t* value = (const uint8_t*)&config + field.offset;
+  switch (field.kind) {
+    case CFG_U32:  return nvs_set_u32(handle, field.key, *(const unsigned long*)value);
+    case CFG_I32:  return nvs_set_i32(handle, field.key, *(const int*)value);
+    case CFG_U16:  return nvs_set_u16(handle, field.key, *(const uint16_t*)value);
+    case CFG_BOOL: return nvs_set_u8(handle, field.key, *(const bool*)value ? 1 : 0);
+    case CFG_STR:  return nvs_set_str(handle, field.key, (const char*)value);
+  }
+  return ESP_FAIL;
+}
+
+// N'écrit que les champs modifiés depuis le dernier chargement/sauvegarde,
+// avec un seul commit. Retourne le nombre d'octets écrits en flash.
+size_t saveConfig(int* changedFields) {
+  config.initialized = true;
+  
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(stateNamespace(), NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    LOG_E("✗ Config save failed: %s", esp_err_to_name(err));
+    return 0;
+  }
+  
+  size_t bytes = 0;
+  int changed = 0;
+  for (const ConfigFieldDesc& field : configFields) {
+    if (!configFieldChanged(field)) continue;
+    
+    err = writeConfigField(handle, field);
+    if (err != ESP_OK) break;
+    bytes += configFieldFlashBytes(field);
+    changed++;
+  }
+  
+  if (err == ESP_OK && changed > 0) err = nvs_commit(handle);
+  nvs_close(handle);
+  
+  if (err != ESP_OK) {
+    LOG_E("✗ Config save failed: %s", esp_err_to_name(err));
+    return 0;
+  }
+  
+  persistedConfig = config;
+  if (changedFields) *changedFields = changed;
   
-  Serial.println("✓ Config saved to flash");
+  LOG_I("✓ Config saved to flash (%d fields, %u bytes)", changed, bytes);
+  return bytes;
 }
 
-void loadAccessCodes() {
-  accessCodeCount = preferences.getInt("codeCount", 0);
-  if (accessCodeCount > 50) accessCodeCount = 0;
+// Annuler les modifications non enregistrées (lot refusé)
+void revertConfig() {
+  bool timezoneChanged = strcmp(config.timezone, persistedConfig.timezone) != 0;
+  bool passwordChanged = strcmp(config.adminPassword, persistedConfig.adminPassword) != 0;
+  config = persistedConfig;
+  if (timezoneChanged) configTzTime(config.timezone, "pool.ntp.org", "time.google.com");
+  if (passwordChanged) authPasswordChanged();
+}
+
+// Nombre de codes que la partition NVS peut stocker (voir config.h)
+static int nvsCodeCapacity() {
+  nvs_stats_t stats;
+  if (nvs_get_stats(NULL, &stats) != ESP_OK) return MAX_CODES_LIMIT;
+  long usable = (long)stats.total_entries * 32 - NVS_RESERVED_BYTES;
+  return max(1L, usable / 2 / NVS_BYTES_PER_CODE);
+}
+
+// Allocation des tables de codes et de logs, une seule fois au démarrage
+void allocateTables() {
+  bool psram = psramFound();
+  
+  accessCodeCapacity = config.maxCodes ? config.maxCodes
+                       : (psram ? DEFAULT_MAX_CODES_PSRAM : DEFAULT_MAX_CODES_INTERNAL);
+  accessLogCapacity = config.maxLogs ? config.maxLogs
+                      : (psram ? DEFAULT_MAX_LOGS_PSRAM : DEFAULT_MAX_LOGS_INTERNAL);
+  accessCodeCapacity = constrain(accessCodeCapacity, 1, MAX_CODES_LIMIT);
+  accessLogCapacity = constrain(accessLogCapacity, 1, MAX_LOGS_LIMIT);
+  
+  int flashCapacity = nvsCodeCapacity();
+  if (accessCodeCapacity > flashCapacity) {
+    LOG_W("⚠ NVS partition holds %d codes at most, capacity reduced from %d",
+          flashCapacity, accessCodeCapacity);
+    accessCodeCapacity = flashCapacity;
+  }
   
-  for (int i = 0; i < accessCodeCount; i++) {
+  accessCodes = (AccessCode*)psramCalloc(accessCodeCapacity, sizeof(AccessCode));
+  accessCodeNames = (uint32_t*)psramCalloc(accessCodeCapacity, sizeof(uint32_t));
+  accessCodeGroups = (uint16_t*)psramCalloc(accessCodeCapacity, sizeof(uint16_t));
+  accessLogs = (AccessLog*)psramCalloc(accessLogCapacity, sizeof(AccessLog));
+  
+  // Capacité trop grande pour la mémoire disponible : revenir aux valeurs sûres
+  if (!accessCodes || !accessCodeNames || !accessCodeGroups || !accessLogs) {
+    LOG_E("✗ Table allocation failed (%d codes, %d logs), using defaults",
+          accessCodeCapacity, accessLogCapacity);
+    psramFree(accessCodes);
+    psramFree(accessCodeNames);
+    psramFree(accessCodeGroups);
+    psramFree(accessLogs);
+    accessCodeCapacity = DEFAULT_MAX_CODES_INTERNAL;
+    accessLogCapacity = DEFAULT_MAX_LOGS_INTERNAL;
+    accessCodeCapacity = min(accessCodeCapacity, flashCapacity);
+    accessCodes = (AccessCode*)calloc(accessCodeCapacity, sizeof(AccessCode));
+    accessCodeNames = (uint32_t*)calloc(accessCodeCapacity, sizeof(uint32_t));
+    accessCodeGroups = (uint16_t*)calloc(accessCodeCapacity, sizeof(uint16_t));
+    accessLogs = (AccessLog*)calloc(accessLogCapacity, sizeof(AccessLog));
+  }
+  
+  LOG_I("✓ Tables allocated in %s: %d codes, %d logs",
+        psram ? "PSRAM" : "internal RAM", accessCodeCapacity, accessLogCapacity);
+}
+
+const char* accessCodeName(int index) {
+  if (index < 0 || index >= accessCodeCount) return "";
+  return namePoolGet(accessCodeNames[index]);
+}
+
+// ===== TABLE DES CODES EN FLASH =====
+// Un seul blob "codeTable" : en-tête, clés (5 octets/code), références de
+// noms, groupes, puis le pool de noms. NVS remplace une entrée de façon
+// atomique (l'ancienne version n'est effacée qu'une fois la nouvelle écrite
+// en entier) : une coupure de courant ou une partition pleine pendant
+// l'écriture laisse la table précédente intacte.
+#define CODE_TABLE_MAGIC 0x31425443  // "CTB1"
+
+struct __attribute__((packed)) CodeTableHeader {
+  uint32_t magic;
+  uint32_t version;   // codeTableVersion
+  uint32_t count;
+  uint32_t poolSize;
+  uint32_t crc;       // CRC32 de tout ce qui suit l'en-tête
+};
+
+static size_t codeTableBytes(uint32_t count, uint32_t poolSize) {
+  return sizeof(CodeTableHeader) +
+         count * (sizeof(AccessCode) + sizeof(uint32_t) + sizeof(uint16_t)) + poolSize;
+}
+
+// Blob complet et cohérent : taille, CRC, noms référencés dans le pool
+bool checkCodeTableBlob(const uint8_t* blob, size_t size, uint32_t& count, const char*& error) {
+  CodeTableHeader header;
+  if (size < sizeof(header)) {
+    error = "Table des codes tronquée";
+    return false;
+  }
+  memcpy(&header, blob, sizeof(header));
+  if (header.magic != CODE_TABLE_MAGIC || header.count > MAX_CODES_LIMIT ||
+      size != codeTableBytes(header.count, header.poolSize)) {
+    error = "Table des codes incohérente";
+    return false;
+  }
+  if (crc32_le(0, blob + sizeof(header), size - sizeof(header)) != header.crc) {
+    error = "CRC de la table des codes invalide";
+    return false;
+  }
+
+  const uint8_t* names = blob + sizeof(header) + header.count * sizeof(AccessCode);
+  for (uint32_t i = 0; i < header.count; i++) {
+    uint32_t ref;
+    memcpy(&ref, names + i * sizeof(uint32_t), sizeof(ref));
+    if (ref != NAME_REF_NONE && ref >= header.poolSize) {
+      error = "Table des codes incohérente";
+      return false;
+    }
+  }
+  count = header.count;
+  return true;
+}
+
+// Blob entier en PSRAM (NVS ne lit pas un blob par morceaux), nullptr si absent
+static uint8_t* readWholeBlob(const char* key, size_t& size) {
+  size = preferences.getBytesLength(key);
+  if (size == 0) return nullptr;
+  uint8_t* blob = (uint8_t*)psramMalloc(size);
+  if (blob && preferences.getBytes(key, blob, size) != size) {
+    psramFree(blob);
+    blob = nullptr;
+  }
+  return blob;
+}
+
+// Ancien format (un blob "codeN" de 40 octets par code), lu pour la migration
+struct LegacyAccessCode {
+  uint32_t code;
+  uint8_t type;
+  char name[32];
+  bool active;
+};
+
+// Table en flash plus grande que la capacité (maxCodes abaissé, partition
+// plus petite) : seuls les premiers codes sont chargés. La flash garde la
+// table complète jusqu'à la prochaine écriture.
+static int clampToCapacity(uint32_t count) {
+  if (count <= (uint32_t)accessCodeCapacity) return count;
+  LOG_W("⚠ Capacity is %d codes: %lu stored code(s) not loaded",
+        accessCodeCapacity, count - accessCodeCapacity);
+  return accessCodeCapacity;
+}
+
+static void migrateLegacyAccessCodes(int legacyCount) {
+  int kept = clampToCapacity(legacyCount);
+  accessCodeCount = 0;
+  
+  for (int i = 0; i < legacyCount && accessCodeCount < kept; i++) {
+    String key = "code" + String(i);
+    LegacyAccessCode legacy;
+    if (preferences.getBytes(key.c_str(), &legacy, sizeof(legacy)) != sizeof(legacy)) continue;
+    
+    legacy.name[sizeof(legacy.name) - 1] = '\0';
+    accessCodes[accessCodeCount].code = legacy.code;
+    accessCodes[accessCodeCount].type = legacy.type;
+    accessCodes[accessCodeCount].active = legacy.active;
+    accessCodeNames[accessCodeCount] = namePoolIntern(legacy.name);
+    accessCodeGroups[accessCodeCount] = GROUP_DEFAULT_MASK;
+    accessCodeCount++;
+  }
+  
+  // Écrire le nouveau format avant d'effacer l'ancien (coupure de courant),
+  // ancien format conservé tant que la capacité ne suffit pas
+  if (kept < legacyCount || !commitAccessCodes(1)) return;
+  for (int i = 0; i < legacyCount; i++) {
     String key = "code" + String(i);
-    preferences.getBytes(key.c_str(), &accessCodes[i], sizeof(AccessCode));
+    preferences.remove(key.c_str());
   }
+  preferences.remove("codeCount");
   
-  Serial.printf("✓ Loaded %d access codes from flash\n", accessCodeCount);
+  LOG_I("✓ Migrated %d access codes to compact layout", accessCodeCount);
+}
+
+// Format intermédiaire : tables en blobs séparés, écrits l'un après l'autre
+static const char* const splitTableKeys[] = {
+  "codeCount", "codeKeys", "codeNames", "namePool", "codeGroups", "codeVer",
+};
+
+// Les `kept` premiers éléments d'une table de `count` éléments
+static bool readSplitTable(const char* key, void* dest, size_t itemSize, int count, int kept) {
+  size_t size = 0;
+  uint8_t* blob = readWholeBlob(key, size);
+  bool ok = blob && size == count * itemSize;
+  if (ok) memcpy(dest, blob, kept * itemSize);
+  psramFree(blob);
+  return ok;
 }
 
-void saveAccessCodes() {
-  preferences.putInt("codeCount", accessCodeCount);
+static void migrateSplitAccessCodes() {
+  int count = preferences.getInt("codeCount", 0);
+  if (count < 0 || count > MAX_CODES_LIMIT) count = 0;
+  int kept = clampToCapacity(count);
+  
+  if (count > 0 &&
+      (!readSplitTable("codeKeys", accessCodes, sizeof(AccessCode), count, kept) ||
+       !readSplitTable("codeNames", accessCodeNames, sizeof(uint32_t), count, kept))) {
+    LOG_E("✗ Access code tables corrupted in flash");
+    return;
+  }
+  if (count > 0 && !readSplitTable("codeGroups", accessCodeGroups, sizeof(uint16_t), count, kept)) {
+    for (int i = 0; i < kept; i++) accessCodeGroups[i] = GROUP_DEFAULT_MASK;
+  }
   
+  size_t poolSize = 0;
+  uint8_t* pool = readWholeBlob("namePool", poolSize);
+  if (pool) namePoolAssign((const char*)pool, poolSize);
+  psramFree(pool);
+  accessCodeCount = kept;
+  codeTableVersion = preferences.getUInt("codeVer", 0);
+  
+  // Anciennes clés effacées seulement une fois le blob unique écrit
+  if (kept < count || !commitAccessCodes(codeTableVersion)) return;
+  for (const char* key : splitTableKeys) preferences.remove(key);
+  LOG_I("✓ Migrated %d access codes to a single table blob", accessCodeCount);
+}
+
+// ===== PIN ENREGISTRÉS SANS LEURS ZÉROS INITIAUX =====
+// L'ancien clavier lisait la saisie avec toInt() : "0123" était enregistré
+// 123. Les codes clavier décimaux présents au premier démarrage de ce format
+// sont listés une fois en flash ("pinLegacy", triée) : pour eux seuls, une
+// saisie à zéros initiaux inconnue retombe sur sa valeur décimale. Un code
+// quitte la liste dès qu'il quitte la table ; les codes ajoutés ensuite n'y
+// entrent jamais.
+static uint32_t* legacyPins = nullptr;
+static uint32_t legacyPinCount = 0;
+
+static int compareKeys(const void* a, const void* b) {
+  uint32_t ka = *(const uint32_t*)a, kb = *(const uint32_t*)b;
+  return ka < kb ? -1 : ka > kb;
+}
+
+static bool isLegacyPin(uint32_t key) {
+  return legacyPinCount > 0 &&
+         bsearch(&key, legacyPins, legacyPinCount, sizeof(uint32_t), compareKeys) != nullptr;
+}
+
+// En flash : nombre de clés puis les clés (liste vide = migration faite)
+static void saveLegacyPins() {
+  size_t size = sizeof(uint32_t) * (legacyPinCount + 1);
+  uint8_t* blob = (uint8_t*)psramMalloc(size);
+  if (!blob) return;
+  memcpy(blob, &legacyPinCount, sizeof(uint32_t));
+  if (legacyPinCount > 0) memcpy(blob + sizeof(uint32_t), legacyPins, size - sizeof(uint32_t));
+  if (preferences.putBytes("pinLegacy", blob, size) != size) LOG_E("✗ Legacy PIN list save failed");
+  psramFree(blob);
+}
+
+// Ne garder que les PIN encore présents dans la table
+static void pruneLegacyPins(bool persist) {
+  if (legacyPinCount == 0) return;
+  uint8_t* present = (uint8_t*)psramCalloc(legacyPinCount, 1);
+  if (!present) return;
   for (int i = 0; i < accessCodeCount; i++) {
-    String key = "code" + String(i);
-    preferences.putBytes(key.c_str(), &accessCodes[i], sizeof(AccessCode));
+    uint32_t key = accessCodes[i].code;
+    if (accessCodes[i].type != 0) continue;
+    uint32_t* found = (uint32_t*)bsearch(&key, legacyPins, legacyPinCount, sizeof(uint32_t), compareKeys);
+    if (found) present[found - legacyPins] = 1;
   }
+  uint32_t kept = 0;
+  for (uint32_t k = 0; k < legacyPinCount; k++) {
+    if (present[k]) legacyPins[kept++] = legacyPins[k];
+  }
+  psramFree(present);
+  if (kept == legacyPinCount) return;
+  legacyPinCount = kept;
+  if (persist) saveLegacyPins();
+}
+
+static void loadLegacyPins() {
+  psramFree(legacyPins);
+  legacyPins = nullptr;
+  legacyPinCount = 0;
+  
+  size_t size = 0;
+  uint8_t* blob = readWholeBlob("pinLegacy", size);
+  if (blob) {
+    uint32_t count = 0;
+    if (size >= sizeof(uint32_t)) memcpy(&count, blob, sizeof(uint32_t));
+    if (count > 0 && count <= MAX_CODES_LIMIT && size == sizeof(uint32_t) * (count + 1)) {
+      legacyPins = (uint32_t*)psramMalloc(count * sizeof(uint32_t));
+      if (legacyPins) {
+        memcpy(legacyPins, blob + sizeof(uint32_t), count * sizeof(uint32_t));
+        legacyPinCount = count;
+      }
+    }
+    psramFree(blob);
+    pruneLegacyPins(false);
+    return;
+  }
+  
+  // Premier démarrage de ce format : tous les codes clavier décimaux
+  uint32_t count = 0;
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].type == 0 && !(accessCodes[i].code & KEYPAD_PIN_FLAG)) count++;
+  }
+  if (count > 0) {
+    legacyPins = (uint32_t*)psramMalloc(count * sizeof(uint32_t));
+    if (!legacyPins) return;  // Retenté au prochain démarrage
+    for (int i = 0; i < accessCodeCount; i++) {
+      if (accessCodes[i].type == 0 && !(accessCodes[i].code & KEYPAD_PIN_FLAG)) {
+        legacyPins[legacyPinCount++] = accessCodes[i].code;
+      }
+    }
+    qsort(legacyPins, legacyPinCount, sizeof(uint32_t), compareKeys);
+  }
+  saveLegacyPins();
+  LOG_I("✓ %lu keypad PIN(s) stored before leading zeros counted, zeros ignored for them",
+        legacyPinCount);
+}
+
+// Saisie à zéros initiaux sans code exact : PIN enregistré avant le
+// changement sous sa valeur décimale ?
+static uint32_t resolveKeypadKey(const KeypadEntry& entry, uint32_t key) {
+  if (!(key & KEYPAD_PIN_FLAG) || entry.value == 0 || entry.value > 0x7FFFFFFF) return key;
+  if (!isLegacyPin((uint32_t)entry.value)) return key;
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == key && accessCodes[i].type == 0) return key;
+  }
+  LOG_D("Keypad entry matched a PIN stored without its leading zeros");
+  return (uint32_t)entry.value;
+}
+
+void loadAccessCodes() {
+  namePoolClear();
+  accessCodeCount = 0;
+  codeTableVersion = 0;
+  
+  size_t size = 0;
+  uint8_t* blob = readWholeBlob("codeTable", size);
+  if (!blob) {
+    if (preferences.isKey("codeKeys")) {
+      migrateSplitAccessCodes();
+    } else {
+      int legacyCount = preferences.getInt("codeCount", 0);
+      if (legacyCount > 0 && legacyCount <= MAX_CODES_LIMIT) migrateLegacyAccessCodes(legacyCount);
+    }
+    codeIndexInvalidate();
+    loadLegacyPins();
+    LOG_I("✓ Loaded %d access codes from flash (version %lu)", accessCodeCount, codeTableVersion);
+    return;
+  }
+  
+  uint32_t count = 0;
+  const char* error = nullptr;
+  if (!checkCodeTableBlob(blob, size, count, error)) {
+    LOG_E("✗ Access code table rejected: %s", error);
+  } else {
+    int kept = clampToCapacity(count);
+    CodeTableHeader header;
+    memcpy(&header, blob, sizeof(header));
+    const uint8_t* cursor = blob + sizeof(header);
+    memcpy(accessCodes, cursor, kept * sizeof(AccessCode));
+    cursor += count * sizeof(AccessCode);
+    memcpy(accessCodeNames, cursor, kept * sizeof(uint32_t));
+    cursor += count * sizeof(uint32_t);
+    memcpy(accessCodeGroups, cursor, kept * sizeof(uint16_t));
+    cursor += count * sizeof(uint16_t);
+    namePoolAssign((const char*)cursor, header.poolSize);
+    accessCodeCount = kept;
+    codeTableVersion = header.version;
+  }
+  psramFree(blob);
+  codeIndexInvalidate();
+  loadLegacyPins();
   
-  Serial.printf("✓ Saved n° %d access code to flash\n", accessCodeCount);
+  LOG_I("✓ Loaded %d access codes from flash (version %lu)", accessCodeCount, codeTableVersion);
+}
+
+// Toute la table et sa version en une seule entrée NVS (voir plus haut)
+bool commitAccessCodes(uint32_t version) {
+  namePoolCompact(accessCodeNames, accessCodeCount);
+  
+  uint32_t count = accessCodeCount;
+  uint32_t poolSize = namePoolSize();
+  size_t size = codeTableBytes(count, poolSize);
+  uint8_t* blob = (uint8_t*)psramMalloc(size);
+  if (!blob) {
+    LOG_E("✗ Access codes save failed: no memory for %u bytes", size);
+    return false;
+  }
+  
+  uint8_t* cursor = blob + sizeof(CodeTableHeader);
+  memcpy(cursor, accessCodes, count * sizeof(AccessCode));
+  cursor += count * sizeof(AccessCode);
+  memcpy(cursor, accessCodeNames, count * sizeof(uint32_t));
+  cursor += count * sizeof(uint32_t);
+  memcpy(cursor, accessCodeGroups, count * sizeof(uint16_t));
+  cursor += count * sizeof(uint16_t);
+  if (poolSize > 0) memcpy(cursor, namePoolData(), poolSize);
+  
+  CodeTableHeader header;
+  header.magic = CODE_TABLE_MAGIC;
+  header.version = version;
+  header.count = count;
+  header.poolSize = poolSize;
+  header.crc = crc32_le(0, blob + sizeof(header), size - sizeof(header));
+  memcpy(blob, &header, sizeof(header));
+  
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(stateNamespace(), NVS_READWRITE, &handle);
+  if (err == ESP_OK) {
+    err = nvs_set_blob(handle, "codeTable", blob, size);
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+  }
+  psramFree(blob);
+  
+  if (err != ESP_OK) {
+    LOG_E("✗ Access codes save failed: %s", esp_err_to_name(err));
+    return false;
+  }
+  
+  codeTableVersion = version;
+  pruneLegacyPins(true);
+  LOG_I("✓ Saved %d access codes to flash (version %lu, %u bytes)", accessCodeCount, version, size);
+  return true;
+}
+
+// Échec d'écriture : la RAM reprend le contenu de la flash (modification annulée)
+bool saveAccessCodes() {
+  if (commitAccessCodes(codeTableVersion + 1)) return true;
+  loadAccessCodes();
+  return false;
 }
 
 // ===== FONCTIONS GESTION ACCÈS =====
-bool checkAccessCode(uint32_t code, uint8_t type) {
+bool checkAccessCode(uint32_t code, uint8_t type, bool* known) {
+  if (known) *known = false;
   for (int i = 0; i < accessCodeCount; i++) {
-    if (accessCodes[i].active && 
-        accessCodes[i].code == code && 
-        accessCodes[i].type == type) {
-      Serial.printf("✓ Code match found: %s (index %d)\n", accessCodes[i].name, i);
+    if (accessCodes[i].code == code && accessCodes[i].type == type) {
+      // Connu même désactivé : les refus sont comptés sur l'identifiant
+      if (known) *known = true;
+      if (!accessCodes[i].active) continue;
+      // Groupes : un ET entre l'appartenance et les groupes autorisés
+      if (!groupsAllow(accessCodeGroups[i])) {
+        LOG_I("✗ Code group revoked: %s (groups 0x%04X)", accessCodeName(i), accessCodeGroups[i]);
+        return false;
+      }
+      // Plage horaire : un simple test de bit sur la grille précalculée
+      if (!scheduleAllows(accessCodes[i].schedule, currentScheduleSlot())) {
+        LOG_I("✗ Code outside its schedule: %s (schedule %d)",
+              accessCodeName(i), accessCodes[i].schedule);
+        return false;
+      }
+      LOG_D("✓ Code match found: %s (index %d)", accessCodeName(i), i);
       return true;
     }
   }
   return false;
 }
 
-void addAccessLog(uint32_t code, bool granted, uint8_t type) {
+void addAccessLog(uint32_t code, bool granted, uint8_t type, uint8_t reader, bool known) {
   accessLogs[logIndex].timestamp = millis();
   accessLogs[logIndex].code = code;
   accessLogs[logIndex].granted = granted;
   accessLogs[logIndex].type = type;
+  accessLogs[logIndex].reader = reader;
+  
+  logIndex = (logIndex + 1) % accessLogCapacity;
   
-  logIndex = (logIndex + 1) % 100;
+  // Statistiques incrémentales : quelques compteurs, pas de parcours du journal
+  statsRecordAccess(code, type, granted, known);
   
-  Serial.printf("Access log: code=%lu, granted=%d, type=%d\n", code, granted, type);
+  LOG_D("Access log: code=%lu, granted=%d, type=%d, reader=%u", code, granted, type, reader);
 }
 
 void handleWiegandInput() {
   // Vérifier timeout du mode apprentissage
-  if (learningMode && (millis() - learningModeStart > LEARNING_TIMEOUT)) {
-    Serial.println("⏱ Learning mode timeout");
+  if (learningMode && (millis() - learningModeStart > learningDuration)) {
+    LOG_I("⏱ Learning mode timeout");
     stopLearningMode();
   }
   
-  // Vérifier timeout du buffer keypad
-  if (keypadBuffer.length() > 0 && (millis() - lastKeypadInput > KEYPAD_TIMEOUT)) {
-    Serial.println("⏱ Keypad timeout - buffer cleared");
-    keypadBuffer = "";
-  }
-  
-  if (wg.available()) {
-    uint8_t bitCount = wg.getWiegandType();
-    uint32_t code = wg.getCode();
-    
-    Serial.printf("\n>>> Wiegand input: %u bits, raw code=%lu (0x%X)\n", bitCount, code, code);
-    
-    // ===== GESTION SELON LE TYPE =====
-    
-    // 1. CODES NUMÉRIQUES (4 bits = 1 chiffre)
-    if (bitCount == 4) {
-      lastKeypadInput = millis();
-      
-      // Touche # = validation (code 13)
-      if (code == 13) {
-        Serial.printf("✓ # pressed - Validating code: %s\n", keypadBuffer.c_str());
-        processKeypadCode();
-        keypadBuffer = "";
-      }
-      // Touche * = annulation (code 14)
-      else if (code == 14) {
-        Serial.println("✗ * pressed - Clearing buffer");
-        keypadBuffer = "";
-        blinkReaderLED(false);
-      }
-      // Chiffres 0-9
-      else if (code <= 9) {
-        keypadBuffer += String(code);
-        Serial.printf("Keypad buffer: %s\n", keypadBuffer.c_str());
-        
-        // Limite à 10 chiffres
-        if (keypadBuffer.length() > 10) {
-          keypadBuffer = keypadBuffer.substring(1);
-        }
-      }
-      else {
-        Serial.printf("⚠ Unknown keypad code: %lu\n", code);
-      }
-    }
-    
-    // 2. DONNÉES 26 BITS (Empreinte OU RFID selon la valeur)
-    else if (bitCount == 26) {
-      // Si le code est simple (< 100), c'est une EMPREINTE validée par le lecteur
-      if (code < 100) {
-        Serial.printf("👆 FINGERPRINT #%lu validated by reader\n", code);
-        
-        // MODE APPRENTISSAGE pour empreinte
-        if (learningMode && learningType == 2) {
-          addNewAccessCode(code, 2, learningName.c_str());
-          stopLearningMode();
-          blinkReaderLED(true);
-          return;
-        }
-        
-        // Vérifier si ce numéro d'empreinte est autorisé dans notre système
-        bool granted = checkAccessCode(code, 2);  // Type 2 = Fingerprint
-        addAccessLog(code, granted, 2);
-        
-        if (granted) {
-          Serial.println("✓✓✓ Fingerprint GRANTED ✓✓✓");
-          blinkReaderLED(true);
-          activateRelay(true);
-          
-          char payload[128];
-          snprintf(payload, sizeof(payload), 
-                   "{\"code\":%lu,\"granted\":true,\"type\":\"fingerprint\",\"bits\":%u}", 
-                   code, bitCount);
-          publishMQTT("access", payload);
-        } else {
-          Serial.println("✗✗✗ Fingerprint DENIED (not authorized in system) ✗✗✗");
-          blinkReaderLED(false);
-          
-          char payload[128];
-          snprintf(payload, sizeof(payload), 
-                   "{\"code\":%lu,\"granted\":false,\"type\":\"fingerprint\",\"reason\":\"not_authorized\",\"bits\":%u}", 
-                   code, bitCount);
-          publishMQTT("access", payload);
-        }
-      }
-      // Sinon (≥ 100), c'est un BADGE RFID 26 bits
-      else {
-        Serial.printf("🔖 RFID badge (26-bit) detected: %lu (0x%06X)\n", code, code);
-        
-        // MODE APPRENTISSAGE pour RFID
-        if (learningMode && learningType == 1) {
-          addNewAccessCode(code, 1, learningName.c_str());
-          stopLearningMode();
-          blinkReaderLED(true);
-          return;
-        }
-        
-        bool granted = checkAccessCode(code, 1);  // Type 1 = RFID
-        addAccessLog(code, granted, 1);
-        
-        if (granted) {
-          Serial.println("✓✓✓ RFID GRANTED ✓✓✓");
-          blinkReaderLED(true);
-          activateRelay(true);
-          
-          char payload[128];
-          snprintf(payload, sizeof(payload), 
-                   "{\"code\":%lu,\"granted\":true,\"type\":\"rfid\",\"bits\":%u}", 
-                   code, bitCount);
-          publishMQTT("access", payload);
-        } else {
-          Serial.println("✗✗✗ RFID DENIED ✗✗✗");
-          blinkReaderLED(false);
-          
-          char payload[128];
-          snprintf(payload, sizeof(payload), 
-                   "{\"code\":%lu,\"granted\":false,\"type\":\"rfid\",\"bits\":%u}", 
-                   code, bitCount);
-          publishMQTT("access", payload);
-        }
-      }
+  // Chaque lecteur a son tampon : deux passages simultanés restent séparés
+  for (uint8_t reader = 0; reader < readerCount; reader++) {
+    // Vérifier timeout du buffer keypad
+    KeypadEntry& entry = keypadEntries[reader];
+    if (!entry.empty() && (millis() - entry.lastInput > KEYPAD_TIMEOUT)) {
+      LOG_D("⏱ Keypad timeout - buffer cleared (reader %u)", reader);
+      entry.clear();
     }
     
-    // 3. BADGE RFID (généralement 34-35 bits, parfois 32 bits)
-    else if (bitCount >= 32) {
-      Serial.printf("🔖 RFID badge detected: %lu (0x%X) - %u bits\n", code, code, bitCount);
-      
-      // MODE APPRENTISSAGE pour RFID
-      if (learningMode && learningType == 1) {
-        addNewAccessCode(code, 1, learningName.c_str());
-        stopLearningMode();
-        blinkReaderLED(true);
-        return;
-      }
-      
-      bool granted = checkAccessCode(code, 1);  // Type 1 = RFID
-      addAccessLog(code, granted, 1);
-      
-      if (granted) {
-        Serial.println("✓✓✓ RFID GRANTED ✓✓✓");
-        blinkReaderLED(true);
-        activateRelay(true);
-        
-        char payload[128];
-        snprintf(payload, sizeof(payload), 
-                 "{\"code\":%lu,\"granted\":true,\"type\":\"rfid\",\"bits\":%u}", 
-                 code, bitCount);
-        publishMQTT("access", payload);
-      } else {
-        Serial.println("✗✗✗ RFID DENIED ✗✗✗");
-        blinkReaderLED(false);
-        
-        char payload[128];
-        snprintf(payload, sizeof(payload), 
-                 "{\"code\":%lu,\"granted\":false,\"type\":\"rfid\",\"bits\":%u}", 
-                 code, bitCount);
-        publishMQTT("access", payload);
-      }
+    uint32_t code;
+    uint8_t bitCount;
+    if (readerRead(reader, code, bitCount)) {
+      handleWiegandFrame(reader, code, bitCount);
     }
-    
-    // 4. AUTRE (format inconnu - probablement 8 ou 24 bits)
-    else {
-      Serial.printf("❓ Unknown Wiegand format: %u bits, code=%lu (0x%X)\n", bitCount, code, code);
+  }
+  
+  // Clignotements des LEDs des lecteurs (non bloquants)
+  readersUpdate();
+  
+  // Prochain réveil : fin de trame, LED, timeout clavier ou fin d'apprentissage
+  unsigned long now = millis();
+  uint32_t wake = readersNextWakeMs();
+  for (uint8_t reader = 0; reader < readerCount; reader++) {
+    if (!keypadEntries[reader].empty()) {
+      unsigned long idle = now - keypadEntries[reader].lastInput;
+      wake = min(wake, (uint32_t)(idle > KEYPAD_TIMEOUT ? 0 : KEYPAD_TIMEOUT - idle + 1));
     }
-    
-    Serial.println();
   }
+  if (learningMode) {
+    unsigned long elapsed = now - learningModeStart;
+    wake = min(wake, (uint32_t)(elapsed > learningDuration ? 0 : learningDuration - elapsed + 1));
+  }
+  if (wake != UINT32_MAX) timerArm(TIMER_READERS, wake);
 }
 
-// Fonction pour traiter le code du clavier
-void processKeypadCode() {
-  if (keypadBuffer.length() == 0) {
-    Serial.println("⚠ Empty keypad buffer");
-    return;
-  }
-  
-  uint32_t code = keypadBuffer.toInt();
-  Serial.printf("🔢 Processing keypad code: %lu\n", code);
+void handleWiegandFrame(uint8_t reader, uint32_t code, uint8_t bitCount) {
+  LOG_D(">>> Wiegand input (reader %u): %u bits, raw code=%lu (0x%X)", reader, bitCount, code, code);
   
-  bool granted = checkAccessCode(code, 0);  // Type 0 = Keypad
-  addAccessLog(code, granted, 0);
+  // ===== GESTION SELON LE TYPE =====
   
-  if (granted) {
-    Serial.println("✓✓✓ Keypad code GRANTED ✓✓✓");
-    blinkReaderLED(true);
-    activateRelay(true);
-    
-    char payload[128];
-    snprintf(payload, sizeof(payload), 
-             "{\"code\":%lu,\"granted\":true,\"type\":\"keypad\"}", 
-             code);
-    publishMQTT("access", payload);
-  } else {
-    Serial.println("✗✗✗ Keypad code DENIED ✗✗✗");
-    blinkReaderLED(false);
+  // 1. CODES NUMÉRIQUES (4 bits = 1 chiffre)
+  if (bitCount == 4) {
+    KeypadEntry& entry = keypadEntries[reader];
+    entry.lastInput = millis();
     
-    char payload[128];
-    snprintf(payload, sizeof(payload), 
-             "{\"code\":%lu,\"granted\":false,\"type\":\"keypad\"}", 
-             code);
-    publishMQTT("access", payload);
-  }
-}
-
-// Fonction pour faire clignoter les LEDs du lecteur
-void blinkReaderLED(bool success) {
-  if (success) {
-    // LED verte - 2 clignotements
-    for(int i=0; i<2; i++) {
-      digitalWrite(READER_LED_GREEN, HIGH);
-      delay(200);
-      digitalWrite(READER_LED_GREEN, LOW);
-      delay(200);
+    // Touche # = validation (code 13)
+    if (code == 13) {
+      LOG_D("✓ # pressed - Validating keypad code");
+      processKeypadCode(reader);
+      entry.clear();
     }
-  } else {
-    // LED rouge - 3 clignotements rapides
-    for(int i=0; i<3; i++) {
-      digitalWrite(READER_LED_RED, HIGH);
-      delay(100);
-      digitalWrite(READER_LED_RED, LOW);
-      delay(100);
+    // Touche * = annulation (code 14)
+    else if (code == 14) {
+      LOG_D("✗ * pressed - Clearing buffer");
+      entry.clear();
+      readerFeedback(reader, false);
+    }
+    // Chiffres 0-9
+    else if (code <= 9) {
+      entry.push(code);
+      LOG_D("Keypad digit received (%u in buffer)", entry.length);
+    }
+    else {
+      LOG_W("⚠ Unknown keypad code: %lu", code);
     }
   }
-}
-
-// ===== FONCTIONS RELAIS =====
-void activateRelay(bool open) {
-  // SÉCURITÉ 1: Ne jamais activer les 2 relais simultanément !
-  digitalWrite(RELAY_OPEN, LOW);
-  digitalWrite(RELAY_CLOSE, LOW);
-  delay(100);  // Pause de sécurité
   
-  // SÉCURITÉ 2: Vérifier que l'autre relais est bien OFF
-  if (open) {
-    if (digitalRead(RELAY_CLOSE) == HIGH) {
-      Serial.println("⚠ ERREUR: RELAY_CLOSE encore actif!");
-      return;
-    }
-  } else {
-    if (digitalRead(RELAY_OPEN) == HIGH) {
-      Serial.println("⚠ ERREUR: RELAY_OPEN encore actif!");
-      return;
+  // 2. DONNÉES 26 BITS (Empreinte OU RFID selon la valeur)
+  // Si le code est simple (< 100), c'est une EMPREINTE validée par le lecteur,
+  // sinon (≥ 100) c'est un BADGE RFID 26 bits
+  else if (bitCount == 26) {
+    if (code < 100) {
+      LOG_D("👆 FINGERPRINT #%lu validated by reader", code);
+      processCredential(reader, code, 2, bitCount);  // Type 2 = Fingerprint
+    } else {
+      LOG_D("🔖 RFID badge (26-bit) detected: %lu (0x%06X)", code, code);
+      processCredential(reader, code, 1, bitCount);  // Type 1 = RFID
     }
   }
   
-  if (relayActive) {
-    deactivateRelay();
-    delay(100);
+  // 3. BADGE RFID (généralement 34-35 bits, parfois 32 bits)
+  else if (bitCount >= 32) {
+    LOG_D("🔖 RFID badge detected: %lu (0x%X) - %u bits", code, code, bitCount);
+    processCredential(reader, code, 1, bitCount);
   }
   
-  digitalWrite(open ? RELAY_OPEN : RELAY_CLOSE, HIGH);
-  relayStartTime = millis();
-  relayActive = true;
+  // 4. AUTRE (format inconnu - probablement 8 ou 24 bits)
+  else {
+    LOG_W("❓ Unknown Wiegand format: %u bits, code=%lu (0x%X)", bitCount, code, code);
+  }
+}
+
+// Vérification d'un identifiant : journal, LEDs du lecteur, portes et MQTT.
+// Retourne vrai si l'accès est accordé.
+bool processCredential(uint8_t reader, uint32_t code, uint8_t type, uint8_t bitCount) {
+  static const char* typeLabels[] = {"Keypad code", "RFID", "Fingerprint"};
+  static const char* typeNames[] = {"keypad", "rfid", "fingerprint"};
+  
+  // MODE APPRENTISSAGE pour RFID et empreinte
+  if (type != 0 && learningMode && learningType == type) {
+    learnCredential(reader, code, type);
+    return false;
+  }
   
-  Serial.printf("⚡ Relay activated: %s for %lums\n", 
-                open ? "OPEN" : "CLOSE", config.relayDuration);
+  bool known;
+  bool granted = checkAccessCode(code, type, &known);
+  addAccessLog(code, granted, type, reader, known);
   
-  char payload[128];
-  snprintf(payload, sizeof(payload), 
-           "{\"action\":\"%s\",\"duration\":%lu}", 
-           open ? "open" : "close", config.relayDuration);
-  publishMQTT("relay", payload);
+  if (granted) {
+    LOG_I("✓✓✓ %s GRANTED (reader %u) ✓✓✓", typeLabels[type], reader);
+    readerFeedback(reader, true);
+    openDoorsForReader(reader);
+  } else {
+    LOG_I("✗✗✗ %s DENIED (reader %u) ✗✗✗", typeLabels[type], reader);
+    readerFeedback(reader, false);
+  }
+  
+  char bits[16] = "";
+  if (type != 0) snprintf(bits, sizeof(bits), ",\"bits\":%u", bitCount);
+  
+  char payload[192];
+  snprintf(payload, sizeof(payload),
+           "{\"code\":%lu,\"granted\":%s,\"type\":\"%s\"%s%s,\"reader\":%u,\"direction\":\"%s\"}",
+           code, granted ? "true" : "false", typeNames[type],
+           (!granted && type == 2) ? ",\"reason\":\"not_authorized\"" : "",
+           bits, reader, readerDirectionName(reader));
+  publishEvent("access", payload);  // Gardé pour plus tard si MQTT est absent
+  return granted;
 }
 
-void deactivateRelay() {
-  digitalWrite(RELAY_OPEN, LOW);
-  digitalWrite(RELAY_CLOSE, LOW);
-  relayActive = false;
+// Fonction pour traiter le code du clavier
+void processKeypadCode(uint8_t reader) {
+  const KeypadEntry& entry = keypadEntries[reader];
+  if (entry.empty()) {
+    LOG_D("⚠ Empty keypad buffer");
+    return;
+  }
   
-  Serial.println("⚡ Relay deactivated");
-  publishMQTT("relay", "{\"action\":\"stopped\"}");
+  // Essais trop rapprochés ou clavier verrouillé : refus sans vérification
+  if (!admitKeypad(reader)) {
+    LOG_I("✗ Keypad attempt throttled (reader %u)", reader);
+    readerFeedback(reader, false);
+    return;
+  }
+  
+  // Saisie trop longue : refusée plutôt que tronquée (aucun code ne peut y
+  // correspondre), mais comptée comme un refus
+  uint32_t code;
+  if (!entry.key(code)) {
+    LOG_I("✗✗✗ Keypad code DENIED (reader %u): entry too long ✗✗✗", reader);
+    addAccessLog(0, false, 0, reader, false);
+    readerFeedback(reader, false);
+    admissionKeypadResult(reader, false);
+    return;
+  }
+  LOG_D("🔢 Processing keypad code");
+  code = resolveKeypadKey(entry, code);
+  
+  bool granted = processCredential(reader, code, 0, 4);  // Type 0 = Keypad
+  admissionKeypadResult(reader, granted);
 }
 
 // ===== FONCTIONS GESTION CODES D'ACCÈS =====
-bool addNewAccessCode(uint32_t code, uint8_t type, const char* name) {
+// Ajout en RAM seulement ; l'appelant décide quand écrire en flash
+bool insertAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule,
+                      uint16_t groups) {
   // Vérifier si le code existe déjà
   for (int i = 0; i < accessCodeCount; i++) {
     if (accessCodes[i].code == code && accessCodes[i].type == type) {
-      Serial.printf("⚠ Code already exists: %lu (type %d)\n", code, type);
+      LOG_W("⚠ Code already exists: %lu (type %d)", code, type);
       return false;
     }
   }
   
+  if (schedule > MAX_SCHEDULES || (schedule != 0 && !schedules[schedule].used)) {
+    LOG_W("⚠ Unknown schedule: %d", schedule);
+    return false;
+  }
+  
   // Vérifier si on a de la place
-  if (accessCodeCount >= 50) {
-    Serial.println("✗ Access codes list full (max 50)");
+  if (accessCodeCount >= accessCodeCapacity) {
+    LOG_E("✗ Access codes list full (max %d)", accessCodeCapacity);
+    return false;
+  }
+  
+  // Ajouter le nouveau code (nom partagé s'il existe déjà dans le pool)
+  uint32_t nameRef = namePoolIntern(name);
+  if (nameRef == NAME_REF_NONE) {
+    LOG_E("✗ Name pool full");
     return false;
   }
   
-  // Ajouter le nouveau code
   accessCodes[accessCodeCount].code = code;
   accessCodes[accessCodeCount].type = type;
-  strncpy(accessCodes[accessCodeCount].name, name, sizeof(accessCodes[accessCodeCount].name) - 1);
-  accessCodes[accessCodeCount].name[sizeof(accessCodes[accessCodeCount].name) - 1] = '\0';
   accessCodes[accessCodeCount].active = true;
+  accessCodes[accessCodeCount].schedule = schedule;
+  accessCodeNames[accessCodeCount] = nameRef;
+  accessCodeGroups[accessCodeCount] = groups;
   
   accessCodeCount++;
-  saveAccessCodes();
+  codeIndexInvalidate();
+  return true;
+}
+
+bool addNewAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule,
+                      uint16_t groups) {
+  if (!insertAccessCode(code, type, name, schedule, groups)) return false;
+  if (!saveAccessCodes()) return false;
   
-  Serial.printf("✓ New access code added: %s (code=%lu, type=%d)\n", name, code, type);
+  LOG_I("✓ New access code added: %s (code=%lu, type=%d)", name, code, type);
   
   // Publication MQTT
   char payload[256];
@@ -683,6 +1109,52 @@ bool addNewAccessCode(uint32_t code, uint8_t type, const char* name) {
   return true;
 }
 
+// Associer (ou retirer avec 0) une plage horaire à un code existant
+bool setAccessCodeSchedule(uint32_t code, uint8_t type, uint8_t schedule) {
+  if (schedule > MAX_SCHEDULES || (schedule != 0 && !schedules[schedule].used)) {
+    LOG_W("⚠ Unknown schedule: %d", schedule);
+    return false;
+  }
+  
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == code && accessCodes[i].type == type) {
+      accessCodes[i].schedule = schedule;
+      if (!saveAccessCodes()) return false;
+      LOG_I("✓ Schedule %d assigned to %s", schedule, accessCodeName(i));
+      return true;
+    }
+  }
+  
+  LOG_W("⚠ Code not found: %lu (type %d)", code, type);
+  return false;
+}
+
+// Remplacer l'appartenance aux groupes d'un code existant
+bool setAccessCodeGroups(uint32_t code, uint8_t type, uint16_t groups) {
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].code == code && accessCodes[i].type == type) {
+      accessCodeGroups[i] = groups;
+      if (!saveAccessCodes()) return false;
+      LOG_I("✓ Groups 0x%04X assigned to %s", groups, accessCodeName(i));
+      return true;
+    }
+  }
+  
+  LOG_W("⚠ Code not found: %lu (type %d)", code, type);
+  return false;
+}
+
+// Retrait en RAM seulement : décaler tous les codes suivants
+void eraseAccessCodeAt(int index) {
+  for (int i = index; i < accessCodeCount - 1; i++) {
+    accessCodes[i] = accessCodes[i + 1];
+    accessCodeNames[i] = accessCodeNames[i + 1];
+    accessCodeGroups[i] = accessCodeGroups[i + 1];
+  }
+  accessCodeCount--;
+  codeIndexInvalidate();
+}
+
 bool removeAccessCode(uint32_t code, uint8_t type) {
   // Chercher le code
   int foundIndex = -1;
@@ -694,23 +1166,18 @@ bool removeAccessCode(uint32_t code, uint8_t type) {
   }
   
   if (foundIndex == -1) {
-    Serial.printf("⚠ Code not found: %lu (type %d)\n", code, type);
+    LOG_W("⚠ Code not found: %lu (type %d)", code, type);
     return false;
   }
   
   // Sauvegarder le nom pour le log
   char removedName[32];
-  strncpy(removedName, accessCodes[foundIndex].name, sizeof(removedName));
+  strlcpy(removedName, accessCodeName(foundIndex), sizeof(removedName));
   
-  // Décaler tous les codes suivants
-  for (int i = foundIndex; i < accessCodeCount - 1; i++) {
-    accessCodes[i] = accessCodes[i + 1];
-  }
+  eraseAccessCodeAt(foundIndex);
+  if (!saveAccessCodes()) return false;
   
-  accessCodeCount--;
-  saveAccessCodes();
-  
-  Serial.printf("✓ Access code removed: %s (code=%lu, type=%d)\n", removedName, code, type);
+  LOG_I("✓ Access code removed: %s (code=%lu, type=%d)", removedName, code, type);
   
   // Publication MQTT
   char payload[256];
@@ -724,25 +1191,20 @@ bool removeAccessCode(uint32_t code, uint8_t type) {
 
 bool deleteAccessCode(int index) {
   if (index < 0 || index >= accessCodeCount) {
-    Serial.printf("⚠ Invalid index for deletion: %d\n", index);
+    LOG_W("⚠ Invalid index for deletion: %d", index);
     return false;
   }
 
   // Sauvegarder les infos pour le log
   char removedName[32];
-  strncpy(removedName, accessCodes[index].name, sizeof(removedName));
+  strlcpy(removedName, accessCodeName(index), sizeof(removedName));
   uint32_t removedCode = accessCodes[index].code;
   uint8_t removedType = accessCodes[index].type;
 
-  // Décaler tous les codes suivants
-  for (int i = index; i < accessCodeCount - 1; i++) {
-    accessCodes[i] = accessCodes[i + 1];
-  }
-
-  accessCodeCount--;
-  saveAccessCodes();
+  eraseAccessCodeAt(index);
+  if (!saveAccessCodes()) return false;
 
-  Serial.printf("✓ Access code removed at index %d: %s (code=%lu, type=%d)\n", index, removedName, removedCode, removedType);
+  LOG_I("✓ Access code removed at index %d: %s (code=%lu, type=%d)", index, removedName, removedCode, removedType);
 
   // Publication MQTT
   char payload[256];
@@ -755,23 +1217,24 @@ bool deleteAccessCode(int index) {
 }
 
 void startLearningMode(uint8_t type, const char* name) {
+  if (learningMode) stopLearningMode();
+  
   learningMode = true;
+  learningBatch = false;
+  learningDuration = LEARNING_TIMEOUT;
   learningModeStart = millis();
   learningType = type;
   learningName = String(name);
   
   const char* typeNames[] = {"Keypad", "RFID", "Fingerprint"};
-  Serial.printf("\n🎓 LEARNING MODE activated for %s\n", typeNames[type]);
-  Serial.printf("Name: %s\n", name);
-  Serial.println("Waiting for input... (60 seconds)");
+  LOG_I("🎓 LEARNING MODE activated for %s", typeNames[type]);
+  LOG_I("Name: %s", name);
+  LOG_I("Waiting for input... (60 seconds)");
   
-  // Clignoter la LED pour indiquer le mode apprentissage
-  for(int i=0; i<5; i++) {
-    digitalWrite(STATUS_LED, HIGH);
-    delay(100);
-    digitalWrite(STATUS_LED, LOW);
-    delay(100);
-  }
+  // Clignoter la LED pour indiquer le mode apprentissage (5 fois, sans
+  // bloquer : basculements faits par readersUpdate())
+  statusLedBlink(5, 100);
+  schedulerPost(EVENT_READERS);  // Arme le timeout et le clignotement
   
   // Publication MQTT
   char payload[256];
@@ -781,10 +1244,103 @@ void startLearningMode(uint8_t type, const char* name) {
   publishMQTT("status", payload);
 }
 
+// Enrôlement d'une série de badges/empreintes en une seule session.
+// Modèle de nom : "{n}" est remplacé par le numéro (ajouté à la fin s'il est absent).
+bool startBatchLearning(uint8_t type, const char* nameTemplate, uint16_t count,
+                        unsigned long timeoutMs, uint16_t firstNumber) {
+  if (type < 1 || type > 2 || nameTemplate == nullptr || strlen(nameTemplate) == 0) return false;
+  if (count > LEARNING_BATCH_MAX) return false;
+  if (learningMode) stopLearningMode();
+  
+  learningMode = true;
+  learningBatch = true;
+  learningDuration = timeoutMs ? timeoutMs : LEARNING_BATCH_TIMEOUT;
+  learningModeStart = millis();
+  learningType = type;
+  schedulerPost(EVENT_READERS);  // Arme le timeout (appel possible depuis le serveur web)
+  learningName = String(nameTemplate);
+  learningTarget = count;
+  learningEnrolled = 0;
+  learningNumber = firstNumber;
+  
+  LOG_I("🎓 BATCH LEARNING activated: type %d, template \"%s\", %u credential(s), %lus",
+        type, nameTemplate, count, learningDuration / 1000);
+  
+  char payload[256];
+  snprintf(payload, sizeof(payload),
+           "{\"learning\":true,\"batch\":true,\"type\":%d,\"name\":\"%s\",\"count\":%u,\"timeout\":%lu}",
+           type, nameTemplate, count, learningDuration / 1000);
+  publishMQTT("status", payload);
+  return true;
+}
+
+static void formatBatchName(char* out, size_t size, uint16_t number) {
+  const char* placeholder = strstr(learningName.c_str(), "{n}");
+  if (placeholder) {
+    snprintf(out, size, "%.*s%u%s", (int)(placeholder - learningName.c_str()),
+             learningName.c_str(), number, placeholder + 3);
+  } else {
+    snprintf(out, size, "%s %u", learningName.c_str(), number);
+  }
+}
+
+void learnCredential(uint8_t reader, uint32_t code, uint8_t type) {
+  if (!learningBatch) {
+    addNewAccessCode(code, type, learningName.c_str());
+    stopLearningMode();
+    readerFeedback(reader, true);
+    return;
+  }
+  
+  char name[32];
+  formatBatchName(name, sizeof(name), learningNumber);
+  bool added = insertAccessCode(code, type, name, 0, GROUP_DEFAULT_MASK);
+  readerFeedback(reader, added);
+  
+  char payload[192];
+  if (added) {
+    learningEnrolled++;
+    learningNumber++;
+    LOG_I("🎓 Batch enrolled %u/%u: %s (code=%lu)", learningEnrolled, learningTarget, name, code);
+    snprintf(payload, sizeof(payload),
+             "{\"event\":\"enrolled\",\"code\":%lu,\"type\":%d,\"name\":\"%s\",\"enrolled\":%u,\"target\":%u}",
+             code, type, name, learningEnrolled, learningTarget);
+  } else {
+    snprintf(payload, sizeof(payload),
+             "{\"event\":\"rejected\",\"code\":%lu,\"type\":%d,\"enrolled\":%u,\"target\":%u}",
+             code, type, learningEnrolled, learningTarget);
+  }
+  publishMQTT("learn/progress", payload);
+  
+  if (learningTarget > 0 && learningEnrolled >= learningTarget) {
+    stopLearningMode();
+  } else if (accessCodeCount >= accessCodeCapacity) {
+    LOG_W("⚠ Access codes list full, ending batch learning");
+    stopLearningMode();
+  }
+}
+
 void stopLearningMode() {
   if (learningMode) {
     learningMode = false;
-    Serial.println("🎓 LEARNING MODE deactivated\n");
+    LOG_I("🎓 LEARNING MODE deactivated");
+    
+    if (learningBatch) {
+      learningBatch = false;
+      // Une seule écriture flash pour toute la série
+      if (learningEnrolled > 0 && !saveAccessCodes()) {
+        LOG_E("✗ Batch learning not saved, %u credential(s) discarded", learningEnrolled);
+        learningEnrolled = 0;
+      }
+      LOG_I("🎓 Batch learning saved %u credential(s)", learningEnrolled);
+      
+      char payload[96];
+      snprintf(payload, sizeof(payload),
+               "{\"learning\":false,\"batch\":true,\"enrolled\":%u,\"total\":%d}",
+               learningEnrolled, accessCodeCount);
+      publishMQTT("status", payload);
+      return;
+    }
     
     // Publication MQTT
     publishMQTT("status", "{\"learning\":false}");
@@ -0,0 +1,91 @@
+#include "metrics.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "logger.h"
+#include <Preferences.h>
+#include <time.h>
+
+extern Preferences preferences;
+
+static DoorMetrics metrics[MAX_DOORS];
+static bool metricsDirty = false;
+static unsigned long lastMetricsSave = 0;
+
+// ===== PERSISTANCE =====
+void loadMetrics() {
+  if (preferences.getBytes("doorMetrics", metrics, sizeof(metrics)) != sizeof(metrics)) {
+    memset(metrics, 0, sizeof(metrics));
+  }
+  lastMetricsSave = millis();
+}
+
+void saveMetrics() {
+  preferences.putBytes("doorMetrics", metrics, sizeof(metrics));
+  metricsDirty = false;
+  lastMetricsSave = millis();
+  LOG_D("Door metrics checkpointed to flash");
+}
+
+void metricsLoop() {
+  if (metricsDirty && millis() - lastMetricsSave >= METRICS_SAVE_INTERVAL) saveMetrics();
+}
+
+// ===== MISE À JOUR =====
+void metricsRelayStarted(uint8_t door, bool open) {
+  if (door >= MAX_DOORS) return;
+  metrics[door].cycles[open]++;
+  metricsDirty = true;
+}
+
+void metricsRelayStopped(uint8_t door, bool open, uint32_t runMs, bool completed) {
+  if (door >= MAX_DOORS) return;
+  metrics[door].runMs[open] += runMs;
+  if (!completed) metrics[door].interrupted++;
+  metricsDirty = true;
+}
+
+void metricsBarrierTrip(uint8_t door) {
+  if (door >= MAX_DOORS) return;
+  metrics[door].barrierTrips++;
+  metricsDirty = true;
+}
+
+// Après remplacement d'un moteur : door = -1 pour toutes les portes
+bool resetMetrics(int door) {
+  if (door < -1 || door >= doorCount) return false;
+
+  time_t now = time(nullptr);
+  for (uint8_t d = 0; d < doorCount; d++) {
+    if (door != -1 && d != door) continue;
+    memset(&metrics[d], 0, sizeof(DoorMetrics));
+    metrics[d].since = now >= 1700000000 ? (uint32_t)now : 0;
+  }
+  saveMetrics();
+  LOG_I("✓ Door metrics reset (door %d)", door);
+  return true;
+}
+
+// ===== EXPORT =====
+void metricsToJson(JsonObject out) {
+  static const char* directions[] = {"close", "open"};
+
+  JsonArray list = out["doors"].to<JsonArray>();
+  for (uint8_t d = 0; d < doorCount; d++) {
+    const DoorMetrics& m = metrics[d];
+    JsonObject door = list.add<JsonObject>();
+    door["door"] = d;
+    door["name"] = doors[d].settings.name;
+
+    for (int dir = 0; dir < 2; dir++) {
+      JsonObject stats = door[directions[dir]].to<JsonObject>();
+      stats["cycles"] = m.cycles[dir];
+      stats["runSeconds"] = m.runMs[dir] / 1000;
+      stats["avgStrokeMs"] = m.cycles[dir] ? m.runMs[dir] / m.cycles[dir] : 0;
+    }
+    door["barrierTrips"] = m.barrierTrips;
+    door["interrupted"] = m.interrupted;
+    door["since"] = m.since;
+  }
+  doorCommandsToJson(out["commands"].to<JsonObject>());
+  out["uptime"] = millis() / 1000;
+}
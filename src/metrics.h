@@ -0,0 +1,33 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// ===== TÉLÉMÉTRIE MOTEUR =====
+// Compteurs d'usure par porte, alimentés par activateRelay()/deactivateRelay()
+// : temps de marche et nombre de cycles par sens, déclenchements de barrière,
+// courses interrompues. Écrits en flash au plus toutes les
+// METRICS_SAVE_INTERVAL ms, seulement s'ils ont changé (quelques écritures
+// par jour au lieu d'une par manœuvre).
+#define METRICS_SAVE_INTERVAL  1800000  // 30 minutes
+
+struct DoorMetrics {
+  uint32_t runMs[2];      // Temps de marche cumulé (0 = fermeture, 1 = ouverture)
+  uint32_t cycles[2];     // Démarrages du moteur par sens
+  uint32_t barrierTrips;
+  uint32_t interrupted;   // Courses arrêtées avant la fin (stop, inversion, barrière)
+  uint32_t since;         // Heure Unix de la dernière remise à zéro (0 = inconnue)
+};
+
+void loadMetrics();
+void saveMetrics();
+void metricsLoop();
+void metricsRelayStarted(uint8_t door, bool open);
+void metricsRelayStopped(uint8_t door, bool open, uint32_t runMs, bool completed);
+void metricsBarrierTrip(uint8_t door);
+bool resetMetrics(int door);
+void metricsToJson(JsonObject out);
+
+#endif
@@ -2,44 +2,226 @@
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "logger.h"
+#include "schedule.h"
+#include "groups.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "code_sync.h"
+#include "batch.h"
+#include "psram_alloc.h"
+#include "stats.h"
+#include "metrics.h"
+#include "boot.h"
+#include "keypad.h"
+#include "admission.h"
+#include "auth.h"
+#include "snapshot.h"
+#include <mbedtls/base64.h>
 
 extern Config config;
+extern int accessCodeCount;
 extern PubSubClient mqttClient;
-extern void activateRelay(bool open);
-extern void deactivateRelay();
-extern bool addNewAccessCode(uint32_t code, uint8_t type, const char* name);
+extern WiFiClient espClient;
+extern bool addNewAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule = 0,
+                             uint16_t groups = GROUP_DEFAULT_MASK);
+extern bool setAccessCodeSchedule(uint32_t code, uint8_t type, uint8_t schedule);
+extern bool setAccessCodeGroups(uint32_t code, uint8_t type, uint16_t groups);
 extern bool removeAccessCode(uint32_t code, uint8_t type);
 extern void startLearningMode(uint8_t type, const char* name);
+extern bool startBatchLearning(uint8_t type, const char* nameTemplate, uint16_t count,
+                               unsigned long timeoutMs, uint16_t firstNumber);
 extern void stopLearningMode();
+bool publishMQTT(const char* subtopic, const char* payload);
+
+// Tampon PubSubClient (256 octets par défaut) : assez grand pour un delta
+// de synchronisation de quelques dizaines de codes
+#define MQTT_BUFFER_SIZE 8192
+
+// La connexion au broker se fait dans loop() : délais courts pour qu'un
+// broker absent ou muet ne bloque pas portes et badges (15 s par défaut
+// dans PubSubClient pour le CONNACK)
+#define MQTT_CONNECT_TIMEOUT_S  2  // Établissement TCP (WiFiClient)
+#define MQTT_SOCKET_TIMEOUT_S   2  // Attente du CONNACK et lectures
+
+// Topics de gestion : message signé obligatoire (auth.h). Les commandes de
+// porte et les lectures (metrics/get, stats/get, sync/get) restent libres.
+static const char* const managementTopics[] = {
+  "doors/set", "metrics/reset", "codes/add", "codes/remove", "codes/schedule",
+  "codes/groups", "groups/set", "schedules/set", "schedules/remove",
+  "sync/delta", "batch", "learn", "learn/batch", "learn/stop",
+  "snapshot/get", "snapshot/restore",
+};
+
+static bool isManagementTopic(const char* topic) {
+  size_t baseLength = strlen(config.mqttTopic);
+  if (strncmp(topic, config.mqttTopic, baseLength) != 0 || topic[baseLength] != '/') return false;
+  for (const char* suffix : managementTopics) {
+    if (strcmp(topic + baseLength + 1, suffix) == 0) return true;
+  }
+  return false;
+}
+
+// Instantané reçu en morceaux signés (le tampon MQTT ne le contient pas) :
+// {"offset":0,"total":N,"data":"<base64>","sections":"codes"}, assemblé en
+// PSRAM dans l'ordre. Un offset 0 recommence (et libère un envoi abandonné).
+// Complet, il est validé dans le callback puis appliqué par mqttApplySnapshot()
+struct SnapshotUpload {
+  uint8_t* data;
+  size_t total;
+  size_t received;
+  uint16_t sections;
+  bool ready;
+};
+static SnapshotUpload snapshotUpload = {nullptr, 0, 0, 0, false};
+
+static void snapshotUploadReset() {
+  psramFree(snapshotUpload.data);
+  snapshotUpload = {nullptr, 0, 0, 0, false};
+}
+
+static void publishSnapshotResult(JsonDocument& result, const char* reason) {
+  if (reason) {
+    result["error"] = reason;
+    LOG_W("MQTT: Snapshot restore rejected: %s", reason);
+  }
+  String payload;
+  serializeJson(result, payload);
+  publishMQTT("snapshot/result", payload.c_str());
+}
+
+// Vrai quand le dernier morceau est arrivé
+static bool receiveSnapshotChunk(JsonVariant chunk, const char*& error) {
+  uint32_t offset = chunk["offset"] | 0;
+  uint32_t total = chunk["total"] | 0;
+  const char* encoded = chunk["data"] | "";
+
+  if (offset == 0) {
+    snapshotUploadReset();
+    snapshotUpload.sections = snapshotSectionsFromText(chunk["sections"] | "");
+    if (!snapshotUpload.sections) {
+      error = "Section inconnue";
+      return false;
+    }
+    if (snapshotUpload.sections & SNAPSHOT_CREDENTIALS) {
+      error = "Identifiants exclus de MQTT";
+      return false;
+    }
+    if (total < sizeof(SnapshotHeader) || total > SNAPSHOT_MAX_SIZE) {
+      error = "Taille d'instantané invalide";
+      return false;
+    }
+    snapshotUpload.data = (uint8_t*)psramMalloc(total);
+    if (!snapshotUpload.data) {
+      error = "Mémoire insuffisante";
+      return false;
+    }
+    snapshotUpload.total = total;
+  }
+
+  if (!snapshotUpload.data || offset != snapshotUpload.received || total != snapshotUpload.total) {
+    snapshotUploadReset();
+    error = "Morceau hors séquence";
+    return false;
+  }
+
+  size_t decoded = 0;
+  if (mbedtls_base64_decode(snapshotUpload.data + offset, total - offset, &decoded,
+                            (const unsigned char*)encoded, strlen(encoded)) != 0 || decoded == 0) {
+    snapshotUploadReset();
+    error = "Morceau invalide (base64)";
+    return false;
+  }
+  snapshotUpload.received += decoded;
+  return snapshotUpload.received == snapshotUpload.total;
+}
+
+// Binaire publié d'un bloc, hors du tampon PubSubClient
+static void publishSnapshot(const uint8_t* data, size_t size) {
+  if (!mqttClient.connected()) return;
+
+  String fullTopic = String(config.mqttTopic) + "/snapshot";
+  bool ok = mqttClient.beginPublish(fullTopic.c_str(), size, false);
+  for (size_t sent = 0; ok && sent < size; ) {
+    size_t chunk = min((size_t)1024, size - sent);
+    ok = mqttClient.write(data + sent, chunk) == chunk;
+    sent += chunk;
+  }
+  if (ok) ok = mqttClient.endPublish() == 1;
+
+  if (ok) {
+    LOG_I("✓ Snapshot published to %s (%u bytes)", fullTopic.c_str(), size);
+  } else {
+    LOG_W("MQTT snapshot publish failed");
+  }
+}
 
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  Serial.print("MQTT message received on topic: ");
-  Serial.println(topic);
+  LOG_D("MQTT message received on topic: %s", topic);
+  
+  // Topic trop bavard : ignoré avant toute analyse
+  if (!admitMqtt(topic)) return;
   
-  // Conversion du payload en string
-  char message[length + 1];
+  // Conversion du payload en string (tampon statique : un delta peut faire
+  // plusieurs Ko, trop pour la pile de loop())
+  static char message[MQTT_BUFFER_SIZE + 1];
+  if (length > MQTT_BUFFER_SIZE) length = MQTT_BUFFER_SIZE;
   memcpy(message, payload, length);
   message[length] = '\0';
   
+  if (isManagementTopic(topic) && !authVerifyMessage(message, length)) return;
+  
   String topicStr = String(topic);
   String baseTopic = String(config.mqttTopic);
   
-  // Topic: roller/cmd - Commandes relais
+  // Topic: roller/cmd - Commandes relais (porte 0)
   if (topicStr == baseTopic + "/cmd") {
-    String cmd = String(message);
-    
-    if (cmd == "open") {
-      Serial.println("MQTT command: OPEN");
-      activateRelay(true);
-    } else if (cmd == "close") {
-      Serial.println("MQTT command: CLOSE");
-      activateRelay(false);
-    } else if (cmd == "stop") {
-      Serial.println("MQTT command: STOP");
-      deactivateRelay();
-    } else {
-      Serial.print("Unknown MQTT command: ");
-      Serial.println(cmd);
+    LOG_I("MQTT command: %s", message);
+    if (!submitDoorAction(0, message, SOURCE_REMOTE)) {
+      LOG_W("Unknown MQTT command: %s", message);
+    }
+  }
+  
+  // Topic: roller/door/<n>/cmd - Commandes relais d'une porte
+  else if (topicStr.startsWith(baseTopic + "/door/") && topicStr.endsWith("/cmd")) {
+    int door = topicStr.substring(baseTopic.length() + 6).toInt();
+    LOG_I("MQTT command: %s (door %d)", message, door);
+    if (!submitDoorAction(door, message, SOURCE_REMOTE)) {
+      LOG_W("Invalid MQTT door command: %s (door %d)", message, door);
+    }
+  }
+  
+  // Topic: roller/doors/set - Réglages d'une porte
+  else if (topicStr == baseTopic + "/doors/set") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    if (!updateDoor(doc.as<JsonVariant>(), reason)) {
+      LOG_W("MQTT: Door update rejected: %s", reason);
+    }
+  }
+  
+  // Topic: roller/metrics/get - Publier la télémétrie moteur
+  else if (topicStr == baseTopic + "/metrics/get") {
+    JsonDocument doc;
+    metricsToJson(doc.to<JsonObject>());
+    
+    String metrics;
+    serializeJson(doc, metrics);
+    publishMQTT("metrics", metrics.c_str());
+  }
+  
+  // Topic: roller/metrics/reset - Numéro de porte, vide = toutes
+  else if (topicStr == baseTopic + "/metrics/reset") {
+    int door = length > 0 ? atoi(message) : -1;
+    if (!resetMetrics(door)) {
+      LOG_W("MQTT: Metrics reset rejected (door %d)", door);
     }
   }
   
@@ -49,20 +231,29 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     DeserializationError error = deserializeJson(doc, message);
     
     if (error) {
-      Serial.print("JSON parse error: ");
-      Serial.println(error.c_str());
+      LOG_W("JSON parse error: %s", error.c_str());
       return;
     }
     
-    if (doc["code"].is<uint32_t>() && doc["type"].is<uint8_t>() && doc["name"].is<const char*>()) {
-      uint32_t code = doc["code"];
+    uint32_t code = doc["code"] | 0;
+    bool validPin = doc["pin"].is<const char*>() && (doc["type"] | 0) == 0 &&
+                    keypadKeyFromText(doc["pin"], code);
+    if ((validPin || doc["code"].is<uint32_t>()) && doc["type"].is<uint8_t>() && doc["name"].is<const char*>()) {
       uint8_t type = doc["type"];
       const char* name = doc["name"];
+      uint8_t schedule = doc["schedule"] | 0;
+      uint16_t groups = doc["groups"] | GROUP_DEFAULT_MASK;
+      
+      // Type sur 2 bits dans AccessCode : 3 et plus seraient tronqués
+      if (code == 0 || type > 2) {
+        LOG_W("MQTT: Invalid code or type (code != 0, type 0-2)");
+        return;
+      }
       
-      Serial.printf("MQTT: Add code %lu, type %d, name %s\n", code, type, name);
-      addNewAccessCode(code, type, name);
+      LOG_I("MQTT: Add code %lu, type %d, name %s", code, type, name);
+      addNewAccessCode(code, type, name, schedule, groups);
     } else {
-      Serial.println("MQTT: Invalid add code format. Expected: {\"code\":123,\"type\":0,\"name\":\"Name\"}");
+      LOG_W("MQTT: Invalid add code format. Expected: {\"code\":123,\"type\":0,\"name\":\"Name\"} or {\"pin\":\"0123\",\"type\":0,...}");
     }
   }
   
@@ -72,59 +263,297 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     DeserializationError error = deserializeJson(doc, message);
     
     if (error) {
-      Serial.print("JSON parse error: ");
-      Serial.println(error.c_str());
+      LOG_W("JSON parse error: %s", error.c_str());
       return;
     }
     
-    if (doc["code"].is<uint32_t>() && doc["type"].is<uint8_t>()) {
-      uint32_t code = doc["code"];
+    uint32_t code = doc["code"] | 0;
+    bool validPin = doc["pin"].is<const char*>() && (doc["type"] | 0) == 0 &&
+                    keypadKeyFromText(doc["pin"], code);
+    if ((validPin || doc["code"].is<uint32_t>()) && doc["type"].is<uint8_t>()) {
       uint8_t type = doc["type"];
       
-      Serial.printf("MQTT: Remove code %lu, type %d\n", code, type);
+      LOG_I("MQTT: Remove code %lu, type %d", code, type);
       removeAccessCode(code, type);
     } else {
-      Serial.println("MQTT: Invalid remove code format. Expected: {\"code\":123,\"type\":0}");
+      LOG_W("MQTT: Invalid remove code format. Expected: {\"code\":123,\"type\":0}");
+    }
+  }
+  
+  // Topic: roller/codes/schedule - Associer une plage horaire à un code
+  else if (topicStr == baseTopic + "/codes/schedule") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    if (doc["code"].is<uint32_t>() && doc["type"].is<uint8_t>() && doc["schedule"].is<uint8_t>()) {
+      setAccessCodeSchedule(doc["code"], doc["type"], doc["schedule"]);
+    } else {
+      LOG_W("MQTT: Invalid schedule format. Expected: {\"code\":123,\"type\":0,\"schedule\":1}");
+    }
+  }
+  
+  // Topic: roller/codes/groups - Groupes d'un code (bitset)
+  else if (topicStr == baseTopic + "/codes/groups") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    if (doc["code"].is<uint32_t>() && doc["type"].is<uint8_t>() && doc["groups"].is<uint16_t>()) {
+      setAccessCodeGroups(doc["code"], doc["type"], doc["groups"]);
+    } else {
+      LOG_W("MQTT: Invalid groups format. Expected: {\"code\":123,\"type\":0,\"groups\":3}");
+    }
+  }
+  
+  // Topic: roller/groups/set - Activer, révoquer ou renommer un groupe
+  else if (topicStr == baseTopic + "/groups/set") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    if (!updateGroup(doc.as<JsonVariant>(), reason)) {
+      LOG_W("MQTT: Group update rejected: %s", reason);
+    }
+  }
+  
+  // Topic: roller/schedules/set - Créer ou remplacer une plage horaire
+  else if (topicStr == baseTopic + "/schedules/set") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    if (!defineSchedule(doc["id"] | 0, doc.as<JsonVariant>(), reason)) {
+      LOG_W("MQTT: Schedule rejected: %s", reason);
     }
   }
   
+  // Topic: roller/schedules/remove - Supprimer une plage horaire
+  else if (topicStr == baseTopic + "/schedules/remove") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    if (!deleteSchedule(doc["id"] | 0, reason)) {
+      LOG_W("MQTT: Schedule not removed: %s", reason);
+    }
+  }
+  
+  // Topic: roller/stats/get - Publier les statistiques d'accès
+  else if (topicStr == baseTopic + "/stats/get") {
+    JsonDocument doc;
+    statsToJson(doc.to<JsonObject>());
+    
+    String stats;
+    serializeJson(doc, stats);
+    publishMQTT("stats", stats.c_str());
+  }
+  
+  // Topic: roller/sync/get - Publier version et empreinte de la table
+  else if (topicStr == baseTopic + "/sync/get") {
+    JsonDocument doc;
+    syncStateToJson(doc.to<JsonObject>(), true);
+    
+    String state;
+    serializeJson(doc, state);
+    publishMQTT("sync/state", state.c_str());
+  }
+  
+  // Topic: roller/sync/delta - Appliquer un lot d'ajouts/suppressions
+  else if (topicStr == baseTopic + "/sync/delta") {
+    JsonDocument doc(&psramJsonAllocator);
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    JsonDocument result;
+    result["ok"] = applyCodeDelta(doc.as<JsonVariant>(), reason);
+    if (reason) {
+      result["error"] = reason;
+      LOG_W("MQTT: Code delta rejected: %s", reason);
+    }
+    syncStateToJson(result.as<JsonObject>(), false);
+    
+    String payload;
+    serializeJson(result, payload);
+    publishMQTT("sync/result", payload.c_str());
+  }
+  
+  // Topic: roller/batch - Lot d'opérations, résultat sur roller/batch/result
+  else if (topicStr == baseTopic + "/batch") {
+    JsonDocument doc(&psramJsonAllocator);
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    JsonDocument result(&psramJsonAllocator);
+    runBatch(doc.as<JsonVariant>(), result.to<JsonObject>());
+    if (doc["id"].is<const char*>() || doc["id"].is<int>()) result["id"] = doc["id"];
+    
+    String payload;
+    serializeJson(result, payload);
+    publishMQTT("batch/result", payload.c_str());
+  }
+  
+  // Topic: roller/snapshot/get - Instantané binaire publié sur roller/snapshot
+  else if (topicStr == baseTopic + "/snapshot/get") {
+    JsonDocument doc;
+    deserializeJson(doc, message);  // Corps vide ({"ts":...}) : SNAPSHOT_ALL
+    
+    uint16_t sections = snapshotSectionsFromText(doc["sections"] | "");
+    if (!sections) {
+      LOG_W("MQTT: Unknown snapshot section: %s", doc["sections"] | "");
+      return;
+    }
+    // Publié sur le broker : jamais de mot de passe (voir snapshot.h)
+    if (sections & SNAPSHOT_CREDENTIALS) {
+      LOG_W("MQTT: Credentials are never exported over MQTT");
+      return;
+    }
+    
+    size_t size = 0;
+    uint8_t* data = snapshotExport(sections, size);
+    if (!data) return;
+    publishSnapshot(data, size);
+    psramFree(data);
+  }
+  
+  // Topic: roller/snapshot/restore - Morceau d'instantané, résultat sur roller/snapshot/result
+  else if (topicStr == baseTopic + "/snapshot/restore") {
+    JsonDocument doc(&psramJsonAllocator);
+    DeserializationError parseError = deserializeJson(doc, message);
+    
+    if (parseError) {
+      LOG_W("JSON parse error: %s", parseError.c_str());
+      return;
+    }
+    
+    const char* reason = nullptr;
+    bool complete = receiveSnapshotChunk(doc.as<JsonVariant>(), reason);
+    if (complete &&
+        snapshotCheck(snapshotUpload.data, snapshotUpload.total, snapshotUpload.sections, reason)) {
+      snapshotUpload.ready = true;  // Résultat publié par mqttApplySnapshot()
+      return;
+    }
+    JsonDocument result;
+    result["ok"] = reason == nullptr;
+    result["received"] = snapshotUpload.received;
+    result["total"] = snapshotUpload.total;
+    if (complete) snapshotUploadReset();
+    publishSnapshotResult(result, reason);
+  }
+  
   // Topic: roller/learn - Activer mode apprentissage
   else if (topicStr == baseTopic + "/learn") {
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, message);
     
     if (error) {
-      Serial.print("JSON parse error: ");
-      Serial.println(error.c_str());
+      LOG_W("JSON parse error: %s", error.c_str());
       return;
     }
     
     if (doc["type"].is<uint8_t>() && doc["name"].is<const char*>()) {
       uint8_t type = doc["type"];
       const char* name = doc["name"];
+      if (type > 2) {
+        LOG_W("MQTT: Invalid learn type %d (0-2)", type);
+        return;
+      }
       
-      Serial.printf("MQTT: Start learning mode - type %d, name %s\n", type, name);
+      LOG_I("MQTT: Start learning mode - type %d, name %s", type, name);
       startLearningMode(type, name);
     } else {
-      Serial.println("MQTT: Invalid learn format. Expected: {\"type\":1,\"name\":\"BadgeName\"}");
-      Serial.println("Types: 0=Keypad, 1=RFID, 2=Fingerprint");
+      LOG_W("MQTT: Invalid learn format. Expected: {\"type\":1,\"name\":\"BadgeName\"}");
+      LOG_W("Types: 0=Keypad, 1=RFID, 2=Fingerprint");
+    }
+  }
+  
+  // Topic: roller/learn/batch - Apprentissage d'une série d'identifiants
+  else if (topicStr == baseTopic + "/learn/batch") {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, message);
+    
+    if (error) {
+      LOG_W("JSON parse error: %s", error.c_str());
+      return;
+    }
+    
+    if (doc["type"].is<uint8_t>() && doc["name"].is<const char*>()) {
+      uint32_t timeoutSec = doc["timeout"] | 0;
+      if (!startBatchLearning(doc["type"], doc["name"], doc["count"] | 0,
+                              timeoutSec * 1000UL, doc["start"] | 1)) {
+        LOG_W("MQTT: Batch learning rejected (type 1-2, count 0-1000)");
+      }
+    } else {
+      LOG_W("MQTT: Invalid batch format. Expected: {\"type\":1,\"name\":\"Badge {n}\",\"count\":50}");
     }
   }
   
   // Topic: roller/learn/stop - Arrêter mode apprentissage
   else if (topicStr == baseTopic + "/learn/stop") {
-    Serial.println("MQTT: Stop learning mode");
+    LOG_I("MQTT: Stop learning mode");
     stopLearningMode();
   }
 }
 
+// Appelé par handleMQTT() après mqttClient.loop() : la restauration rouvre
+// `preferences` et recharge les tables, jamais au milieu de la réception
+void mqttApplySnapshot() {
+  if (!snapshotUpload.ready) return;
+  
+  const char* reason = nullptr;
+  uint16_t applied = 0;
+  JsonDocument result;
+  result["ok"] = snapshotRestore(snapshotUpload.data, snapshotUpload.total,
+                                 snapshotUpload.sections, applied, reason);
+  snapshotSectionsToJson(applied, result["sections"].to<JsonArray>());
+  result["codes"] = accessCodeCount;
+  result["version"] = codeTableVersion;
+  snapshotUploadReset();
+  publishSnapshotResult(result, reason);
+}
+
 void setupMQTT() {
   if (strlen(config.mqttServer) > 0) {
     mqttClient.setServer(config.mqttServer, config.mqttPort);
     mqttClient.setCallback(mqttCallback);
-    Serial.printf("MQTT configured: %s:%d\n", config.mqttServer, config.mqttPort);
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+    mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+    espClient.setTimeout(MQTT_CONNECT_TIMEOUT_S);
+    LOG_I("MQTT configured: %s:%d", config.mqttServer, config.mqttPort);
   } else {
-    Serial.println("MQTT not configured");
+    LOG_I("MQTT not configured");
   }
 }
 
@@ -132,7 +561,7 @@ void reconnectMQTT() {
   if (strlen(config.mqttServer) == 0) return;
   
   if (!mqttClient.connected()) {
-    Serial.print("Attempting MQTT connection...");
+    LOG_D("Attempting MQTT connection...");
     
     String clientId = "ESP32-Roller-" + String(random(0xffff), HEX);
     
@@ -146,41 +575,86 @@ void reconnectMQTT() {
     }
     
     if (connected) {
-      Serial.println(" connected!");
+      LOG_I("MQTT connected!");
       
       // Souscription aux topics de commande
       String baseTopic = String(config.mqttTopic);
       
       mqttClient.subscribe((baseTopic + "/cmd").c_str());
+      mqttClient.subscribe((baseTopic + "/door/+/cmd").c_str());
+      mqttClient.subscribe((baseTopic + "/doors/set").c_str());
+      mqttClient.subscribe((baseTopic + "/metrics/get").c_str());
+      mqttClient.subscribe((baseTopic + "/metrics/reset").c_str());
       mqttClient.subscribe((baseTopic + "/codes/add").c_str());
       mqttClient.subscribe((baseTopic + "/codes/remove").c_str());
+      mqttClient.subscribe((baseTopic + "/codes/schedule").c_str());
+      mqttClient.subscribe((baseTopic + "/schedules/set").c_str());
+      mqttClient.subscribe((baseTopic + "/schedules/remove").c_str());
+      mqttClient.subscribe((baseTopic + "/codes/groups").c_str());
+      mqttClient.subscribe((baseTopic + "/groups/set").c_str());
       mqttClient.subscribe((baseTopic + "/learn").c_str());
       mqttClient.subscribe((baseTopic + "/learn/stop").c_str());
+      mqttClient.subscribe((baseTopic + "/learn/batch").c_str());
+      mqttClient.subscribe((baseTopic + "/stats/get").c_str());
+      mqttClient.subscribe((baseTopic + "/sync/get").c_str());
+      mqttClient.subscribe((baseTopic + "/sync/delta").c_str());
+      mqttClient.subscribe((baseTopic + "/batch").c_str());
+      mqttClient.subscribe((baseTopic + "/snapshot/get").c_str());
+      mqttClient.subscribe((baseTopic + "/snapshot/restore").c_str());
       
       // Publication du statut de connexion
       mqttClient.publish((baseTopic + "/status").c_str(), "{\"state\":\"online\"}");
       
-      Serial.println("Subscribed to MQTT topics:");
-      Serial.printf("  - %s/cmd\n", baseTopic.c_str());
-      Serial.printf("  - %s/codes/add\n", baseTopic.c_str());
-      Serial.printf("  - %s/codes/remove\n", baseTopic.c_str());
-      Serial.printf("  - %s/learn\n", baseTopic.c_str());
-      Serial.printf("  - %s/learn/stop\n", baseTopic.c_str());
+      // Durées de démarrage, une fois par démarrage
+      static bool bootReported = false;
+      if (!bootReported) {
+        bootMark("mqtt");
+        JsonDocument boot;
+        bootToJson(boot.to<JsonObject>());
+        String payload;
+        serializeJson(boot, payload);
+        mqttClient.publish((baseTopic + "/boot").c_str(), payload.c_str());
+        bootReported = true;
+      }
+      
+      LOG_I("Subscribed to MQTT topics:");
+      LOG_I("  - %s/cmd", baseTopic);
+      LOG_I("  - %s/door/+/cmd", baseTopic);
+      LOG_I("  - %s/doors/set", baseTopic);
+      LOG_I("  - %s/metrics/get", baseTopic);
+      LOG_I("  - %s/metrics/reset", baseTopic);
+      LOG_I("  - %s/codes/add", baseTopic);
+      LOG_I("  - %s/codes/remove", baseTopic);
+      LOG_I("  - %s/codes/schedule", baseTopic);
+      LOG_I("  - %s/schedules/set", baseTopic);
+      LOG_I("  - %s/schedules/remove", baseTopic);
+      LOG_I("  - %s/codes/groups", baseTopic);
+      LOG_I("  - %s/groups/set", baseTopic);
+      LOG_I("  - %s/learn", baseTopic);
+      LOG_I("  - %s/learn/stop", baseTopic);
+      LOG_I("  - %s/learn/batch", baseTopic);
+      LOG_I("  - %s/stats/get", baseTopic);
+      LOG_I("  - %s/sync/get", baseTopic);
+      LOG_I("  - %s/sync/delta", baseTopic);
+      LOG_I("  - %s/batch", baseTopic);
+      LOG_I("  - %s/snapshot/get", baseTopic);
+      LOG_I("  - %s/snapshot/restore", baseTopic);
     } else {
-      Serial.print(" failed, rc=");
-      Serial.println(mqttClient.state());
+      LOG_W("MQTT connection failed, rc=%d", mqttClient.state());
     }
   }
 }
 
-void publishMQTT(const char* subtopic, const char* payload) {
-  if (!mqttClient.connected()) return;
+// Faux si MQTT est absent ou si le client n'a pas pu envoyer le message
+bool publishMQTT(const char* subtopic, const char* payload) {
+  if (!mqttClient.connected()) return false;
   
   String fullTopic = String(config.mqttTopic) + "/" + String(subtopic);
   
-  if (mqttClient.publish(fullTopic.c_str(), payload)) {
-    Serial.printf("MQTT published to %s: %s\n", fullTopic.c_str(), payload);
-  } else {
-    Serial.println("MQTT publish failed");
+  if (!mqttClient.publish(fullTopic.c_str(), payload)) {
+    LOG_W("MQTT publish failed");
+    return false;
   }
+  LOG_D("MQTT published to %s: %s", fullTopic, payload);
+  return true;
 }
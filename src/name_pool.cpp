@@ -0,0 +1,139 @@
+#include "name_pool.h"
+#include "psram_alloc.h"
+
+static char* poolData = nullptr;
+static uint32_t poolUsed = 0;
+static uint32_t poolCapacity = 0;
+
+// Table de hachage (adressage ouvert) des offsets pour l'interning en O(1)
+static uint32_t* poolHash = nullptr;
+static uint32_t poolHashSize = 0;   // Puissance de 2
+static uint32_t poolStrings = 0;
+
+static uint32_t hashName(const char* s) {
+  uint32_t h = 2166136261u;  // FNV-1a
+  while (*s) {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void hashInsert(uint32_t ref) {
+  uint32_t mask = poolHashSize - 1;
+  uint32_t slot = hashName(poolData + ref) & mask;
+  while (poolHash[slot] != NAME_REF_NONE) slot = (slot + 1) & mask;
+  poolHash[slot] = ref;
+}
+
+static bool hashResize(uint32_t size) {
+  uint32_t* table = (uint32_t*)psramMalloc(size * sizeof(uint32_t));
+  if (!table) return false;
+
+  memset(table, 0xFF, size * sizeof(uint32_t));
+  psramFree(poolHash);
+  poolHash = table;
+  poolHashSize = size;
+
+  // Réinsérer toutes les chaînes du pool
+  for (uint32_t ref = 0; ref < poolUsed; ref += strlen(poolData + ref) + 1) {
+    hashInsert(ref);
+  }
+  return true;
+}
+
+static uint32_t hashFind(const char* name) {
+  if (poolHashSize == 0) return NAME_REF_NONE;
+
+  uint32_t mask = poolHashSize - 1;
+  uint32_t slot = hashName(name) & mask;
+  while (poolHash[slot] != NAME_REF_NONE) {
+    if (strcmp(poolData + poolHash[slot], name) == 0) return poolHash[slot];
+    slot = (slot + 1) & mask;
+  }
+  return NAME_REF_NONE;
+}
+
+uint32_t namePoolIntern(const char* name) {
+  if (name == nullptr) name = "";
+
+  uint32_t existing = hashFind(name);
+  if (existing != NAME_REF_NONE) return existing;
+
+  uint32_t len = strlen(name) + 1;
+  if (poolUsed + len > poolCapacity) {
+    uint32_t capacity = poolCapacity ? poolCapacity : 512;
+    while (poolUsed + len > capacity) capacity *= 2;
+
+    char* grown = (char*)psramRealloc(poolData, capacity);
+    if (!grown) return NAME_REF_NONE;
+    poolData = grown;
+    poolCapacity = capacity;
+  }
+
+  uint32_t ref = poolUsed;
+  memcpy(poolData + ref, name, len);
+  poolUsed += len;
+  poolStrings++;
+
+  // Facteur de charge max 50%
+  if (poolStrings * 2 > poolHashSize) {
+    if (!hashResize(poolHashSize ? poolHashSize * 2 : 64)) return ref;
+  } else {
+    hashInsert(ref);
+  }
+  return ref;
+}
+
+const char* namePoolGet(uint32_t ref) {
+  if (ref == NAME_REF_NONE || ref >= poolUsed) return "";
+  return poolData + ref;
+}
+
+uint32_t namePoolSize() {
+  return poolUsed;
+}
+
+const char* namePoolData() {
+  return poolData;
+}
+
+void namePoolClear() {
+  psramFree(poolData);
+  psramFree(poolHash);
+  poolData = nullptr;
+  poolHash = nullptr;
+  poolUsed = poolCapacity = poolHashSize = poolStrings = 0;
+}
+
+// Charger un pool sauvegardé tel quel (offsets conservés)
+bool namePoolAssign(const char* data, uint32_t size) {
+  namePoolClear();
+  if (size == 0) return true;
+
+  poolData = (char*)psramMalloc(size);
+  if (!poolData) return false;
+  memcpy(poolData, data, size);
+  poolData[size - 1] = '\0';
+  poolUsed = poolCapacity = size;
+
+  uint32_t hashSize = 64;
+  for (uint32_t ref = 0; ref < poolUsed; ref += strlen(poolData + ref) + 1) poolStrings++;
+  while (hashSize < poolStrings * 2) hashSize *= 2;
+  return hashResize(hashSize);
+}
+
+// Supprimer les noms qui ne sont plus référencés ; `refs` est mis à jour
+void namePoolCompact(uint32_t* refs, int count) {
+  char* old = poolData;
+  uint32_t oldUsed = poolUsed;
+  psramFree(poolHash);
+  poolData = nullptr;
+  poolHash = nullptr;
+  poolUsed = poolCapacity = poolHashSize = poolStrings = 0;
+
+  for (int i = 0; i < count; i++) {
+    refs[i] = refs[i] < oldUsed ? namePoolIntern(old + refs[i]) : namePoolIntern("");
+  }
+  psramFree(old);
+}
@@ -0,0 +1,21 @@
+#ifndef NAME_POOL_H
+#define NAME_POOL_H
+
+#include <Arduino.h>
+
+// Pool de noms "froid" des identifiants : chaînes terminées par '\0' mises
+// bout à bout, référencées par leur offset. Les noms identiques sont
+// partagés (interning). Le pool n'est lu que pour l'affichage et les logs,
+// jamais pendant la vérification d'un code. Utilisé depuis loop() seulement :
+// l'interning réalloue le pool, le compactage le remplace.
+#define NAME_REF_NONE 0xFFFFFFFF
+
+uint32_t namePoolIntern(const char* name);
+const char* namePoolGet(uint32_t ref);
+uint32_t namePoolSize();
+const char* namePoolData();
+bool namePoolAssign(const char* data, uint32_t size);
+void namePoolCompact(uint32_t* refs, int count);
+void namePoolClear();
+
+#endif
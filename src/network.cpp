@@ -0,0 +1,162 @@
+#include "network.h"
+#include "config.h"
+#include "logger.h"
+#include "boot.h"
+#include "scheduler.h"
+#include <WiFi.h>
+#include <WiFiManager.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+
+extern Config config;
+extern WiFiManager wifiManager;
+extern AsyncWebServer server;
+
+void setupWebServer();
+void setupMQTT();
+
+enum NetworkState : uint8_t {
+  NET_CONNECTING,
+  NET_CONNECTED,
+  NET_PORTAL,
+  NET_BACKOFF
+};
+
+static std::atomic<uint8_t> networkState(NET_CONNECTING);
+static std::atomic<bool> wifiReady(false);
+static std::atomic<uint32_t> connectCount(0);
+static std::atomic<uint32_t> failedAttempts(0);
+static std::atomic<uint32_t> retryAt(0);
+static bool servicesStarted = false;
+
+// ===== TÂCHE RÉSEAU =====
+static bool waitForConnection(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - start >= timeoutMs) return false;
+    vTaskDelay(pdMS_TO_TICKS(250));
+  }
+  return true;
+}
+
+static void onConnected() {
+  LOG_I("✓✓✓ WiFi CONNECTED ✓✓✓");
+  LOG_I("IP Address: %s", WiFi.localIP().toString());
+  LOG_I("Gateway: %s", WiFi.gatewayIP().toString());
+  LOG_I("RSSI: %d dBm", WiFi.RSSI());
+
+  if (connectCount.fetch_add(1) == 0) {
+    bootMark("wifi");
+    // Heure locale pour les plages horaires (synchronisation en arrière-plan)
+    configTzTime(config.timezone, "pool.ntp.org", "time.google.com");
+  }
+  failedAttempts.store(0);
+  digitalWrite(STATUS_LED, LOW);
+  networkState.store(NET_CONNECTED);
+  wifiReady.store(true, std::memory_order_release);
+  schedulerPost(EVENT_NETWORK);
+}
+
+// Une tentative : identifiants enregistrés, ou portail si l'ESP32 n'en a pas
+static bool tryConnect() {
+  digitalWrite(STATUS_LED, HIGH);
+
+  if (!wifiManager.getWiFiIsSaved()) {
+    // Le portail occupe le port 80 : uniquement avant le démarrage du serveur web
+    if (wifiReady.load()) return false;
+
+    LOG_I("No saved WiFi credentials, access point started:");
+    LOG_I("SSID: ESP32-Roller-Setup (no password)");
+    LOG_I("Connect and configure WiFi at: http://192.168.4.1");
+    networkState.store(NET_PORTAL);
+    bool saved = wifiManager.startConfigPortal("ESP32-Roller-Setup");
+    wifiManager.stopConfigPortal();
+    if (!saved) return false;
+  } else {
+    LOG_D("Connecting to saved WiFi...");
+    networkState.store(NET_CONNECTING);
+    WiFi.begin();
+  }
+  return waitForConnection(NETWORK_CONNECT_TIMEOUT_MS);
+}
+
+static void networkTask(void* arg) {
+  wifiManager.setConfigPortalTimeout(NETWORK_PORTAL_TIMEOUT_S);
+  wifiManager.setConnectTimeout(30);        // 30 secondes pour se connecter
+  wifiManager.setDebugOutput(true);
+
+  // Configuration WiFi pour compatibilité Freebox
+  WiFi.mode(WIFI_STA);
+  WiFi.setTxPower(WIFI_POWER_19_5dBm);  // Réduire la puissance pour éviter les timeouts
+  WiFi.setAutoReconnect(false);         // Reconnexions gérées ici, avec backoff
+  WiFi.persistent(true);
+
+  for (;;) {
+    if (WiFi.status() == WL_CONNECTED) {
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+
+    if (networkState.load() == NET_CONNECTED) {
+      LOG_W("⚠ WiFi disconnected! Access control continues offline");
+    }
+
+    if (tryConnect()) {
+      onConnected();
+      continue;
+    }
+
+    // Backoff exponentiel : 5 s, 10 s, 20 s ... 5 minutes
+    uint32_t failures = failedAttempts.fetch_add(1) + 1;
+    uint32_t delayMs = (uint32_t)NETWORK_BACKOFF_MIN_MS << (failures > 7 ? 6 : failures - 1);
+    if (delayMs > NETWORK_BACKOFF_MAX_MS) delayMs = NETWORK_BACKOFF_MAX_MS;
+    LOG_W("⚠ WiFi unavailable (attempt %lu), retrying in %lu s", failures, delayMs / 1000);
+
+    WiFi.disconnect();
+    digitalWrite(STATUS_LED, LOW);
+    networkState.store(NET_BACKOFF);
+    retryAt.store(millis() + delayMs);
+    vTaskDelay(pdMS_TO_TICKS(delayMs));
+  }
+}
+
+void networkBegin() {
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, NULL, 1, NULL, 0);
+}
+
+// ===== SERVICES =====
+// Serveur web et MQTT démarrés depuis loop(), une seule fois : ils
+// survivent aux reconnexions suivantes
+void networkUpdate() {
+  if (servicesStarted || !wifiReady.load(std::memory_order_acquire)) return;
+
+  setupWebServer();
+  setupMQTT();
+  server.begin();
+  servicesStarted = true;
+
+  LOG_I("✓ Web server started");
+  LOG_I("Access the web interface at: http://%s", WiFi.localIP().toString());
+  bootMark("services");
+}
+
+bool networkConnected() {
+  return WiFi.status() == WL_CONNECTED;
+}
+
+bool networkServicesStarted() {
+  return servicesStarted;
+}
+
+void networkToJson(JsonObject out) {
+  static const char* stateNames[] = {"connecting", "connected", "portal", "backoff"};
+
+  uint8_t state = networkState.load();
+  out["state"] = stateNames[state];
+  out["connections"] = connectCount.load();
+  out["failedAttempts"] = failedAttempts.load();
+  if (state == NET_BACKOFF) {
+    int32_t remaining = (int32_t)(retryAt.load() - millis());
+    out["retryInS"] = max<int32_t>(remaining, 0) / 1000;
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== RÉSEAU EN ARRIÈRE-PLAN =====
+// Le contrôle d'accès ne dépend jamais du réseau : la connexion WiFi est un
+// service géré par une tâche dédiée sur le cœur 0, qui ne redémarre jamais
+// l'ESP32. Sans identifiants enregistrés, le portail WiFiManager s'ouvre
+// pour NETWORK_PORTAL_TIMEOUT_S ; sinon, ou après un échec, nouvelles
+// tentatives avec un délai doublé à chaque fois (NETWORK_BACKOFF_MIN_MS à
+// NETWORK_BACKOFF_MAX_MS). loop() démarre le serveur web et MQTT à la
+// première connexion.
+#define NETWORK_TASK_STACK        8192
+#define NETWORK_CONNECT_TIMEOUT_MS  20000
+#define NETWORK_PORTAL_TIMEOUT_S  180
+#define NETWORK_BACKOFF_MIN_MS    5000
+#define NETWORK_BACKOFF_MAX_MS    300000  // 5 minutes
+
+void networkBegin();
+void networkUpdate();
+bool networkConnected();
+bool networkServicesStarted();
+void networkToJson(JsonObject out);
+
+#endif
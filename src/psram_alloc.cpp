@@ -0,0 +1,34 @@
+#include "psram_alloc.h"
+#include <esp_heap_caps.h>
+
+PsramJsonAllocator psramJsonAllocator;
+
+static const uint32_t PSRAM_CAPS = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+void* psramMalloc(size_t size) {
+  if (psramFound()) {
+    void* ptr = heap_caps_malloc(size, PSRAM_CAPS);
+    if (ptr) return ptr;
+  }
+  return malloc(size);
+}
+
+void* psramCalloc(size_t count, size_t size) {
+  if (psramFound()) {
+    void* ptr = heap_caps_calloc(count, size, PSRAM_CAPS);
+    if (ptr) return ptr;
+  }
+  return calloc(count, size);
+}
+
+void* psramRealloc(void* ptr, size_t size) {
+  if (psramFound()) {
+    void* moved = heap_caps_realloc(ptr, size, PSRAM_CAPS);
+    if (moved) return moved;
+  }
+  return realloc(ptr, size);
+}
+
+void psramFree(void* ptr) {
+  heap_caps_free(ptr);  // Valable pour la RAM interne comme pour la PSRAM
+}
@@ -0,0 +1,25 @@
+#ifndef PSRAM_ALLOC_H
+#define PSRAM_ALLOC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Allocations volumineuses : PSRAM externe si la carte en possède (WROVER),
+// sinon repli sur le heap interne. La RAM interne reste ainsi disponible
+// pour les buffers WiFi/TCP.
+void* psramMalloc(size_t size);
+void* psramCalloc(size_t count, size_t size);
+void* psramRealloc(void* ptr, size_t size);
+void psramFree(void* ptr);
+
+// Allocateur ArduinoJson pour les gros documents (listes de codes, logs)
+class PsramJsonAllocator : public ArduinoJson::Allocator {
+ public:
+  void* allocate(size_t size) override { return psramMalloc(size); }
+  void deallocate(void* ptr) override { psramFree(ptr); }
+  void* reallocate(void* ptr, size_t newSize) override { return psramRealloc(ptr, newSize); }
+};
+
+extern PsramJsonAllocator psramJsonAllocator;
+
+#endif
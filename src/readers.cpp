@@ -0,0 +1,184 @@
+#include "readers.h"
+#include "logger.h"
+#include "scheduler.h"
+#include <atomic>
+
+const ReaderPins readerPins[] = READER_TABLE;
+const uint8_t readerCount = sizeof(readerPins) / sizeof(readerPins[0]);
+static_assert(sizeof(readerPins) / sizeof(readerPins[0]) <= MAX_READERS, "READER_TABLE: trop de lecteurs");
+
+// Tampon rempli par les interruptions d'un lecteur. `bits` est publié après
+// `data` : la boucle le remet à 0 par compare-and-swap, ce qui échoue si une
+// impulsion est arrivée entre-temps (la trame n'était pas terminée).
+struct ReaderBuffer {
+  volatile uint64_t data;
+  volatile uint32_t lastPulse;
+  std::atomic<uint8_t> bits;
+};
+
+struct ReaderLine {
+  ReaderBuffer* buffer;
+  uint8_t bit;  // 0 pour D0, 1 pour D1
+};
+
+// Retour visuel non bloquant : nombre de basculements restants de la LED
+struct ReaderFeedback {
+  int8_t pin;
+  uint8_t toggles;
+  uint16_t halfPeriod;
+  unsigned long nextToggle;
+};
+
+static ReaderBuffer buffers[MAX_READERS];
+static ReaderLine lines[MAX_READERS][2];
+static ReaderFeedback feedback[MAX_READERS];
+static ReaderFeedback statusFeedback = {STATUS_LED, 0, 0, 0};
+
+static void IRAM_ATTR onWiegandPulse(void* arg) {
+  ReaderLine* line = (ReaderLine*)arg;
+  ReaderBuffer* buffer = line->buffer;
+
+  uint8_t count = buffer->bits.load(std::memory_order_relaxed);
+  if (count < 64) {
+    uint64_t data = count == 0 ? 0 : buffer->data;  // Nouvelle trame
+    buffer->data = (data << 1) | line->bit;
+    buffer->bits.store(count + 1, std::memory_order_release);
+  }
+  buffer->lastPulse = micros();
+  schedulerPostFromISR(EVENT_READERS);
+}
+
+// Les interruptions sont rattachées au cœur qui appelle readersBegin(),
+// celui de loop() : une impulsion ne peut pas s'exécuter en parallèle d'une
+// lecture, seulement l'interrompre (détecté par le compare-and-swap).
+void readersBegin() {
+  for (uint8_t r = 0; r < readerCount; r++) {
+    const ReaderPins& pins = readerPins[r];
+
+    if (pins.ledRed != PIN_NONE) {
+      pinMode(pins.ledRed, OUTPUT);
+      digitalWrite(pins.ledRed, LOW);
+    }
+    if (pins.ledGreen != PIN_NONE) {
+      pinMode(pins.ledGreen, OUTPUT);
+      digitalWrite(pins.ledGreen, LOW);
+    }
+
+    buffers[r].bits.store(0);
+    lines[r][0] = {&buffers[r], 0};
+    lines[r][1] = {&buffers[r], 1};
+
+    pinMode(pins.d0, INPUT_PULLUP);
+    pinMode(pins.d1, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(pins.d0), onWiegandPulse, &lines[r][0], FALLING);
+    attachInterruptArg(digitalPinToInterrupt(pins.d1), onWiegandPulse, &lines[r][1], FALLING);
+
+    LOG_I("✓ Wiegand reader %u initialized on pins %d & %d (%s)",
+          r, pins.d0, pins.d1, readerDirectionName(r));
+  }
+}
+
+// Même interprétation des formats que l'ancienne bibliothèque Wiegand :
+// 4 bits = touche, 8 bits = touche + complément, 26/34 bits = badge sans
+// les bits de parité de début et de fin.
+static bool decodeFrame(uint64_t data, uint8_t count, uint32_t& code, uint8_t& bits) {
+  bits = count;
+
+  if (count == 4) {
+    code = data & 0x0F;
+  } else if (count == 8) {
+    uint8_t high = (data >> 4) & 0x0F;
+    uint8_t low = data & 0x0F;
+    if ((high ^ 0x0F) != low) return false;  // Complément invalide
+    code = low;
+    bits = 4;  // Traité comme une touche 4 bits
+  } else if (count == 26) {
+    code = (data >> 1) & 0xFFFFFF;
+  } else if (count >= 32) {
+    code = (data >> 1) & 0xFFFFFFFF;
+  } else {
+    code = data & 0xFFFFFFFF;
+  }
+  return true;
+}
+
+bool readerRead(uint8_t reader, uint32_t& code, uint8_t& bits) {
+  ReaderBuffer& buffer = buffers[reader];
+
+  uint8_t count = buffer.bits.load(std::memory_order_acquire);
+  if (count == 0) return false;
+  if (micros() - buffer.lastPulse < WIEGAND_FRAME_GAP_US) return false;
+
+  uint64_t data = buffer.data;
+  if (!buffer.bits.compare_exchange_strong(count, 0, std::memory_order_acq_rel)) {
+    return false;  // Trame encore en cours de réception
+  }
+
+  if (!decodeFrame(data, count, code, bits)) {
+    LOG_W("⚠ Reader %u: invalid %u-bit frame", reader, count);
+    return false;
+  }
+  return true;
+}
+
+// LED verte : 2 clignotements de 200 ms, LED rouge : 3 clignotements de 100 ms
+void readerFeedback(uint8_t reader, bool success) {
+  if (reader >= readerCount) return;
+  const ReaderPins& pins = readerPins[reader];
+  ReaderFeedback& fb = feedback[reader];
+
+  if (fb.toggles > 0 && fb.pin != PIN_NONE) digitalWrite(fb.pin, LOW);
+
+  fb.pin = success ? pins.ledGreen : pins.ledRed;
+  fb.toggles = success ? 4 : 6;
+  fb.halfPeriod = success ? 200 : 100;
+  fb.nextToggle = millis();
+}
+
+// LED d'état (mode apprentissage) : mêmes basculements, éteinte à la fin
+void statusLedBlink(uint8_t blinks, uint16_t halfPeriodMs) {
+  statusFeedback.toggles = blinks * 2;
+  statusFeedback.halfPeriod = halfPeriodMs;
+  statusFeedback.nextToggle = millis();
+}
+
+static void stepFeedback(ReaderFeedback& fb, unsigned long now) {
+  if (fb.toggles == 0 || (long)(now - fb.nextToggle) < 0) return;
+
+  if (fb.pin != PIN_NONE) digitalWrite(fb.pin, fb.toggles % 2 == 0 ? HIGH : LOW);
+  fb.toggles--;
+  fb.nextToggle = now + fb.halfPeriod;
+}
+
+static uint32_t feedbackWakeMs(const ReaderFeedback& fb, unsigned long now) {
+  if (fb.toggles == 0) return UINT32_MAX;
+  long untilToggle = (long)(fb.nextToggle - now);
+  return (uint32_t)max(untilToggle, 0L);
+}
+
+void readersUpdate() {
+  unsigned long now = millis();
+  for (uint8_t r = 0; r < readerCount; r++) stepFeedback(feedback[r], now);
+  stepFeedback(statusFeedback, now);
+}
+
+// Prochain réveil utile : fin d'une trame en cours ou basculement d'une LED
+uint32_t readersNextWakeMs() {
+  uint32_t wake = UINT32_MAX;
+  unsigned long now = millis();
+
+  for (uint8_t r = 0; r < readerCount; r++) {
+    if (buffers[r].bits.load(std::memory_order_relaxed) > 0) {
+      uint32_t quiet = micros() - buffers[r].lastPulse;
+      uint32_t gapMs = quiet >= WIEGAND_FRAME_GAP_US ? 0 : (WIEGAND_FRAME_GAP_US - quiet) / 1000 + 1;
+      wake = min(wake, gapMs);
+    }
+    wake = min(wake, feedbackWakeMs(feedback[r], now));
+  }
+  return min(wake, feedbackWakeMs(statusFeedback, now));
+}
+
+const char* readerDirectionName(uint8_t reader) {
+  if (reader >= readerCount) return "in";
+  return readerPins[reader].direction == READER_DIR_OUT ? "out" : "in";
+}
@@ -0,0 +1,25 @@
+#ifndef READERS_H
+#define READERS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== LECTEURS WIEGAND =====
+// Décodage de N lecteurs en parallèle : chaque ligne D0/D1 a son interruption
+// qui accumule les bits dans le tampon de son lecteur. La boucle principale
+// récupère une trame quand la ligne est silencieuse depuis WIEGAND_FRAME_GAP_US.
+// Aucun verrou : un lecteur n'écrit que dans son propre tampon.
+#define WIEGAND_FRAME_GAP_US  25000
+
+extern const ReaderPins readerPins[];
+extern const uint8_t readerCount;
+
+void readersBegin();
+bool readerRead(uint8_t reader, uint32_t& code, uint8_t& bits);
+void readerFeedback(uint8_t reader, bool success);
+void statusLedBlink(uint8_t blinks, uint16_t halfPeriodMs);  // LED d'état, depuis loop()
+void readersUpdate();
+uint32_t readersNextWakeMs();
+const char* readerDirectionName(uint8_t reader);
+
+#endif
@@ -0,0 +1,170 @@
+#include "schedule.h"
+#include "logger.h"
+#include <Preferences.h>
+#include <time.h>
+#include "config.h"
+
+extern Preferences preferences;
+extern AccessCode* accessCodes;
+extern int accessCodeCount;
+
+Schedule schedules[MAX_SCHEDULES + 1];  // Index 0 inutilisé (= toujours autorisé)
+
+// ===== PERSISTANCE =====
+void loadSchedules() {
+  size_t len = preferences.getBytes("schedules", &schedules[1], sizeof(Schedule) * MAX_SCHEDULES);
+  if (len != sizeof(Schedule) * MAX_SCHEDULES) {
+    memset(schedules, 0, sizeof(schedules));
+  }
+
+  int count = 0;
+  for (int id = 1; id <= MAX_SCHEDULES; id++) {
+    if (schedules[id].used) count++;
+  }
+  LOG_I("✓ Loaded %d schedules from flash", count);
+}
+
+void saveSchedules() {
+  preferences.putBytes("schedules", &schedules[1], sizeof(Schedule) * MAX_SCHEDULES);
+  LOG_I("✓ Schedules saved to flash");
+}
+
+// ===== HORLOGE =====
+// Quart d'heure courant de la semaine, recalculé seulement au changement
+// de quart d'heure. SCHEDULE_NO_CLOCK tant que SNTP n'a pas répondu.
+uint16_t currentScheduleSlot() {
+  static uint16_t cachedSlot = SCHEDULE_NO_CLOCK;
+  static time_t cachedUntil = 0;
+
+  time_t now = time(nullptr);
+  if (now < 1700000000) return SCHEDULE_NO_CLOCK;
+  if (now < cachedUntil) return cachedSlot;
+
+  struct tm local;
+  localtime_r(&now, &local);
+  cachedSlot = local.tm_wday * SCHEDULE_SLOTS_DAY + local.tm_hour * 4 + local.tm_min / 15;
+  cachedUntil = now + (15 - local.tm_min % 15) * 60 - local.tm_sec;
+  return cachedSlot;
+}
+
+// ===== GESTION DES PLAGES =====
+bool scheduleInUse(uint8_t id) {
+  for (int i = 0; i < accessCodeCount; i++) {
+    if (accessCodes[i].schedule == id) return true;
+  }
+  return false;
+}
+
+// Créer ou remplacer la plage `id` à partir de sa description JSON
+bool defineSchedule(int id, JsonVariant json, const char*& error) {
+  if (id < 1 || id > MAX_SCHEDULES) {
+    error = "ID de plage invalide (1-31)";
+    return false;
+  }
+
+  Schedule parsed;
+  if (!scheduleFromJson(json, parsed, error)) return false;
+
+  schedules[id] = parsed;
+  saveSchedules();
+  LOG_I("✓ Schedule %d defined: %s", id, parsed.name);
+  return true;
+}
+
+// Refusé si des codes l'utilisent encore : les libérer ouvrirait leur accès
+bool deleteSchedule(int id, const char*& error) {
+  if (id < 1 || id > MAX_SCHEDULES || !schedules[id].used) {
+    error = "Plage introuvable";
+    return false;
+  }
+  if (scheduleInUse(id)) {
+    error = "Plage utilisée par des codes";
+    return false;
+  }
+
+  memset(&schedules[id], 0, sizeof(Schedule));
+  saveSchedules();
+  LOG_I("✓ Schedule %d removed", id);
+  return true;
+}
+
+// ===== CONVERSION JSON =====
+// "HH:MM" -> minutes depuis minuit, -1 si invalide
+static int parseTimeOfDay(const char* text) {
+  if (!text) return -1;
+  int hours, minutes;
+  if (sscanf(text, "%d:%d", &hours, &minutes) != 2) return -1;
+  if (hours < 0 || hours > 24 || minutes < 0 || minutes > 59) return -1;
+  if (hours == 24 && minutes != 0) return -1;
+  return hours * 60 + minutes;
+}
+
+static void setSlots(Schedule& schedule, int day, int startMin, int endMin) {
+  // Quart d'heure de début arrondi en dessous, de fin arrondi au-dessus
+  int first = startMin / 15;
+  int last = (endMin + 14) / 15;
+  if (last <= first) last += SCHEDULE_SLOTS_DAY;  // Plage qui passe minuit
+
+  for (int slot = first; slot < last; slot++) {
+    int index = (day * SCHEDULE_SLOTS_DAY + slot) % SCHEDULE_SLOTS;
+    schedule.bits[index >> 3] |= 1 << (index & 7);
+  }
+}
+
+// Format attendu :
+// {"name":"Ménage","windows":[{"days":[1,2,3,4,5],"from":"06:00","to":"09:00"}]}
+// Jours : 0=dimanche ... 6=samedi
+bool scheduleFromJson(JsonVariant json, Schedule& out, const char*& error) {
+  memset(&out, 0, sizeof(out));
+  strlcpy(out.name, json["name"] | "", sizeof(out.name));
+
+  JsonArray windows = json["windows"];
+  if (windows.isNull() || windows.size() == 0) {
+    error = "windows manquant";
+    return false;
+  }
+
+  for (JsonVariant window : windows) {
+    int startMin = parseTimeOfDay(window["from"].as<const char*>());
+    int endMin = parseTimeOfDay(window["to"].as<const char*>());
+    if (startMin < 0 || endMin < 0) {
+      error = "Heure invalide (HH:MM)";
+      return false;
+    }
+
+    JsonArray days = window["days"];
+    if (days.isNull() || days.size() == 0) {
+      error = "days manquant";
+      return false;
+    }
+
+    for (JsonVariant day : days) {
+      int d = day | -1;
+      if (d < 0 || d > 6) {
+        error = "Jour invalide (0-6)";
+        return false;
+      }
+      setSlots(out, d, startMin, endMin);
+    }
+  }
+
+  out.used = true;
+  return true;
+}
+
+// Grille exportée en 7 chaînes hexadécimales de 24 caractères (96 bits/jour)
+void scheduleToJson(uint8_t id, JsonObject out) {
+  const Schedule& schedule = schedules[id];
+  out["id"] = id;
+  out["name"] = schedule.name;
+
+  JsonArray days = out["days"].to<JsonArray>();
+  const uint8_t bytesPerDay = SCHEDULE_SLOTS_DAY / 8;
+  for (int d = 0; d < 7; d++) {
+    char hex[bytesPerDay * 2 + 1];
+    for (int b = 0; b < bytesPerDay; b++) {
+      snprintf(hex + b * 2, 3, "%02x", schedule.bits[d * bytesPerDay + b]);
+    }
+    days.add(hex);
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== PLAGES HORAIRES =====
+// Chaque plage est une grille hebdomadaire précalculée de 7 x 96 quarts
+// d'heure (1 bit = accès autorisé). Les codes y font référence par leur ID
+// (AccessCode::schedule, 0 = pas de restriction). La vérification d'un badge
+// se résume à un test de bit.
+#define MAX_SCHEDULES       31   // IDs 1-31 (5 bits dans AccessCode)
+#define SCHEDULE_SLOTS_DAY  96
+#define SCHEDULE_SLOTS      (7 * SCHEDULE_SLOTS_DAY)
+#define SCHEDULE_NO_CLOCK   0xFFFF
+
+struct Schedule {
+  char name[16];
+  bool used;
+  uint8_t bits[SCHEDULE_SLOTS / 8];  // Index = jour (0=dimanche) * 96 + quart d'heure
+};
+
+extern Schedule schedules[MAX_SCHEDULES + 1];
+
+void loadSchedules();
+void saveSchedules();
+uint16_t currentScheduleSlot();
+bool scheduleInUse(uint8_t id);
+bool defineSchedule(int id, JsonVariant json, const char*& error);
+bool deleteSchedule(int id, const char*& error);
+bool scheduleFromJson(JsonVariant json, Schedule& out, const char*& error);
+void scheduleToJson(uint8_t id, JsonObject out);
+
+// Test en O(1) : deux opérations sur bits une fois le quart d'heure connu
+inline bool scheduleAllows(uint8_t id, uint16_t slot) {
+  if (id == 0) return true;
+  if (id > MAX_SCHEDULES || !schedules[id].used || slot == SCHEDULE_NO_CLOCK) return false;
+  return schedules[id].bits[slot >> 3] & (1 << (slot & 7));
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "scheduler.h"
+#include "logger.h"
+#include <atomic>
+
+static TaskHandle_t loopTask = nullptr;
+
+// Un seul appel en attente à la fois ; l'état arbitre entre l'appelant qui
+// abandonne et loop() qui prend l'appel
+enum CallState : uint8_t { CALL_IDLE, CALL_PENDING, CALL_RUNNING };
+
+static SemaphoreHandle_t callMutex = nullptr;
+static SemaphoreHandle_t callDone = nullptr;
+static const std::function<void()>* callJob = nullptr;
+static std::atomic<uint8_t> callState(CALL_IDLE);
+
+// Horloge 64 bits : pas de saut au débordement de millis() (49 jours)
+static uint32_t nowTick() {
+  return (uint32_t)(esp_timer_get_time() / (SCHEDULER_TICK_MS * 1000));
+}
+
+void schedulerBegin() {
+  callMutex = xSemaphoreCreateMutex();
+  callDone = xSemaphoreCreateBinary();
+  loopTask = xTaskGetCurrentTaskHandle();
+  timerWheelBegin(nowTick);
+}
+
+// ===== ÉVÉNEMENTS =====
+void schedulerPost(uint32_t events) {
+  if (loopTask) xTaskNotify(loopTask, events, eSetBits);
+}
+
+void IRAM_ATTR schedulerPostFromISR(uint32_t events) {
+  if (!loopTask) return;
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(loopTask, events, eSetBits, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+// Bloque loop() jusqu'à la prochaine échéance ou au prochain événement
+SchedulerWake schedulerWait() {
+  SchedulerWake wake = {0, timerWheelAdvance()};
+  uint32_t waitMs = wake.timers ? 0 : timerWheelNextDeadlineMs();
+
+  uint32_t events = 0;
+  xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(waitMs));
+  wake.events = events;
+  wake.timers |= timerWheelAdvance();
+  return wake;
+}
+
+// ===== APPELS =====
+bool schedulerCall(const std::function<void()>& job, uint32_t timeoutMs) {
+  if (!loopTask || xTaskGetCurrentTaskHandle() == loopTask) {
+    job();
+    return true;
+  }
+  if (xSemaphoreTake(callMutex, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) return false;
+  
+  callJob = &job;
+  callState = CALL_PENDING;
+  schedulerPost(EVENT_CALL);
+  
+  if (xSemaphoreTake(callDone, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+    uint8_t expected = CALL_PENDING;
+    if (callState.compare_exchange_strong(expected, CALL_IDLE)) {
+      // Jamais pris par loop() : abandonné
+      xSemaphoreGive(callMutex);
+      LOG_W("⚠ loop() busy, call abandoned after %lu ms", timeoutMs);
+      return false;
+    }
+    // Déjà en cours : `job` référence encore la pile de l'appelant
+    xSemaphoreTake(callDone, portMAX_DELAY);
+  }
+  
+  callState = CALL_IDLE;
+  xSemaphoreGive(callMutex);
+  return true;
+}
+
+void schedulerRunCall() {
+  uint8_t expected = CALL_PENDING;
+  if (!callState.compare_exchange_strong(expected, CALL_RUNNING)) return;
+  (*callJob)();
+  xSemaphoreGive(callDone);
+}
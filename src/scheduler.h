@@ -0,0 +1,52 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "timer_wheel.h"
+#include <functional>
+
+// ===== ORDONNANCEUR DE LOOP() =====
+// loop() dort jusqu'à la prochaine échéance ou au prochain événement au lieu
+// de tout interroger toutes les 10 ms :
+//  - échéances : une roue de temporisation (timer_wheel.h), un
+//    temporisateur fixe par composant, armé par le composant lui-même (fin
+//    de trame Wiegand, temps mort du relais, ...) ;
+//  - événements : bits de notification de la tâche loop(), postés par les
+//    interruptions (Wiegand, interrupteurs, bouton BOOT) et les autres
+//    tâches (serveur web, réseau) ;
+//  - appels : schedulerCall() exécute une fonction dans loop() pour le
+//    compte d'une autre tâche (serveur web) et attend son résultat. La table
+//    des codes et son pool de noms ne sont modifiés et lus que par loop().
+// TIMER_HOUSEKEEPING relance tous les composants au moins une fois par
+// seconde : une échéance oubliée ne bloque jamais un composant.
+
+// Événements (bits de notification)
+#define EVENT_READERS       (1u << 0)
+#define EVENT_SWITCHES      (1u << 1)
+#define EVENT_DOOR_COMMAND  (1u << 2)
+#define EVENT_NETWORK       (1u << 3)
+#define EVENT_RESET_BUTTON  (1u << 4)
+#define EVENT_CALL          (1u << 5)
+
+// Attente maximale d'un appel avant que loop() ne le prenne en charge (un
+// appel commencé est toujours attendu jusqu'au bout)
+#define SCHEDULER_CALL_TIMEOUT_MS  3000
+
+struct SchedulerWake {
+  uint32_t events;
+  uint32_t timers;  // Bit (1 << TimerId) par temporisateur échu
+
+  bool fired(TimerId id) const { return timers & (1u << id); }
+};
+
+void schedulerBegin();
+void schedulerPost(uint32_t events);          // Depuis n'importe quelle tâche
+void schedulerPostFromISR(uint32_t events);
+SchedulerWake schedulerWait();
+
+// Faux si loop() n'a pas pris l'appel à temps (`job` n'est alors pas exécuté).
+// Appelé depuis loop() (callback MQTT), `job` est exécuté directement.
+bool schedulerCall(const std::function<void()>& job, uint32_t timeoutMs = SCHEDULER_CALL_TIMEOUT_MS);
+void schedulerRunCall();  // Depuis loop(), sur EVENT_CALL
+
+#endif
@@ -0,0 +1,539 @@
+#include "snapshot.h"
+#include "config.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include "schedule.h"
+#include "groups.h"
+#include "doors.h"
+#include "stats.h"
+#include "auth.h"
+#include <Preferences.h>
+#include <nvs.h>
+#include <rom/crc.h>
+
+extern Config config;
+extern Preferences preferences;
+extern int accessCodeCapacity;
+extern int accessCodeCount;
+extern void loadConfig();
+extern void loadAccessCodes();
+extern bool checkCodeTableBlob(const uint8_t* blob, size_t size, uint32_t& count, const char*& error);
+
+// ===== ESPACES NVS =====
+// L'état vit dans l'un de deux espaces NVS, désigné par l'entrée "active"
+// de META_NAMESPACE. Une restauration remplit l'autre espace puis bascule
+// cette seule entrée (écriture NVS atomique) : une coupure de courant ou une
+// partition pleine avant la bascule laisse l'état précédent intact.
+#define META_NAMESPACE "rollerMeta"
+static const char* const stateNamespaces[2] = {"roller", "rollerB"};
+static uint8_t activeGeneration = 0;
+
+const char* stateNamespace() {
+  return stateNamespaces[activeGeneration];
+}
+
+static void eraseNamespace(const char* name) {
+  nvs_handle_t handle;
+  if (nvs_open(name, NVS_READWRITE, &handle) != ESP_OK) return;
+  if (nvs_erase_all(handle) == ESP_OK) nvs_commit(handle);
+  nvs_close(handle);
+}
+
+void snapshotBegin() {
+  nvs_handle_t handle;
+  uint8_t active = 0;
+  if (nvs_open(META_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+    nvs_get_u8(handle, "active", &active);
+    nvs_close(handle);
+  }
+  activeGeneration = active ? 1 : 0;
+
+  // Copie laissée par une restauration interrompue (avant ou après la bascule)
+  const char* inactive = stateNamespaces[activeGeneration ^ 1];
+  nvs_iterator_t it = nvs_entry_find(NVS_DEFAULT_PART_NAME, inactive, NVS_TYPE_ANY);
+  if (it) {
+    nvs_release_iterator(it);
+    eraseNamespace(inactive);
+    LOG_W("⚠ Leftover NVS namespace %s erased", inactive);
+  }
+}
+
+// ===== LISTE BLANCHE =====
+// Entrées NVS de l'état de l'appareil. Les compteurs moteur (doorMetrics)
+// et les identifiants WiFi restent propres à chaque appareil.
+enum SnapshotType : uint8_t { SNAP_U8, SNAP_U16, SNAP_U32, SNAP_I32, SNAP_STR, SNAP_BLOB };
+
+struct SnapshotKey {
+  const char* key;
+  uint8_t section;
+  uint8_t type;
+  uint32_t size;  // Chaîne : capacité (zéro compris) ; blob : taille exacte, 0 = variable
+};
+
+static const SnapshotKey snapshotKeys[] = {
+  {"relayDur",   SNAPSHOT_CONFIG,       SNAP_U32,  4},
+  {"photoEn",    SNAPSHOT_CONFIG,       SNAP_U8,   1},
+  {"mqttPort",   SNAPSHOT_CONFIG,       SNAP_I32,  4},
+  {"mqttSrv",    SNAPSHOT_CONFIG,       SNAP_STR,  sizeof(Config::mqttServer)},
+  {"mqttUser",   SNAPSHOT_CONFIG,       SNAP_STR,  sizeof(Config::mqttUser)},
+  {"mqttPass",   SNAPSHOT_CREDENTIALS,  SNAP_STR,  sizeof(Config::mqttPassword)},
+  {"mqttTop",    SNAPSHOT_CONFIG,       SNAP_STR,  sizeof(Config::mqttTopic)},
+  {"adminPw",    SNAPSHOT_CREDENTIALS,  SNAP_STR,  sizeof(Config::adminPassword)},
+  {"tz",         SNAPSHOT_CONFIG,       SNAP_STR,  sizeof(Config::timezone)},
+  {"maxCodes",   SNAPSHOT_CONFIG,       SNAP_U16,  2},
+  {"maxLogs",    SNAPSHOT_CONFIG,       SNAP_U16,  2},
+  {"init",       SNAPSHOT_CONFIG,       SNAP_U8,   1},
+  {"doors",      SNAPSHOT_CONFIG,       SNAP_BLOB, sizeof(DoorSettings) * MAX_DOORS},
+  {"doorTravel", SNAPSHOT_CONFIG,       SNAP_BLOB, sizeof(DoorTravel) * MAX_DOORS},
+  {"codeTable",  SNAPSHOT_CODES,        SNAP_BLOB, 0},
+  {"pinLegacy",  SNAPSHOT_CODES,        SNAP_BLOB, 0},
+  {"grpMask",    SNAPSHOT_GROUPS,       SNAP_U16,  2},
+  {"grpNames",   SNAPSHOT_GROUPS,       SNAP_BLOB, sizeof(groupNames)},
+  {"schedules",  SNAPSHOT_SCHEDULES,    SNAP_BLOB, sizeof(Schedule) * MAX_SCHEDULES},
+  {"stats",      SNAPSHOT_STATS,        SNAP_BLOB, sizeof(AccessStats)},
+  {"statsCodes", SNAPSHOT_STATS,        SNAP_BLOB, 0},
+};
+
+#define SNAPSHOT_KEY_COUNT (sizeof(snapshotKeys) / sizeof(snapshotKeys[0]))
+
+static const char* const sectionNames[] = {
+  "config", "codes", "groups", "schedules", "stats", "credentials",
+};
+
+struct __attribute__((packed)) SnapshotEntry {
+  uint8_t type;
+  uint8_t keyLength;
+  uint32_t length;
+};
+
+// Données d'une entrée dans l'instantané reçu (data nul = absente)
+struct EntryRef {
+  const uint8_t* data;
+  uint32_t length;
+};
+
+static int findKey(const char* name, size_t length) {
+  for (size_t k = 0; k < SNAPSHOT_KEY_COUNT; k++) {
+    if (strlen(snapshotKeys[k].key) == length && memcmp(snapshotKeys[k].key, name, length) == 0) return k;
+  }
+  return -1;
+}
+
+static const EntryRef& entryFor(const EntryRef* entries, const char* name) {
+  return entries[findKey(name, strlen(name))];
+}
+
+uint16_t snapshotSectionsFromText(const char* text) {
+  if (!text || !*text) return SNAPSHOT_ALL;
+
+  uint16_t mask = 0;
+  while (*text) {
+    const char* end = strchr(text, ',');
+    size_t length = end ? (size_t)(end - text) : strlen(text);
+    uint16_t bit = 0;
+    for (size_t s = 0; s < sizeof(sectionNames) / sizeof(sectionNames[0]); s++) {
+      if (strlen(sectionNames[s]) == length && strncmp(text, sectionNames[s], length) == 0) bit = 1 << s;
+    }
+    if (!bit) return 0;
+    mask |= bit;
+    text += length;
+    if (*text == ',') text++;
+  }
+  return mask;
+}
+
+void snapshotSectionsToJson(uint16_t sections, JsonArray out) {
+  for (size_t s = 0; s < sizeof(sectionNames) / sizeof(sectionNames[0]); s++) {
+    if (sections & (1 << s)) out.add(sectionNames[s]);
+  }
+}
+
+// ===== EXPORT =====
+// `out` nul : taille seulement. ESP_ERR_NVS_NOT_FOUND si l'entrée est absente.
+static esp_err_t readEntry(nvs_handle_t handle, const SnapshotKey& key, uint8_t* out, size_t& length) {
+  uint32_t scalar = 0;
+  esp_err_t err;
+  switch (key.type) {
+    case SNAP_U8:  err = nvs_get_u8(handle, key.key, (uint8_t*)&scalar); break;
+    case SNAP_U16: err = nvs_get_u16(handle, key.key, (uint16_t*)&scalar); break;
+    case SNAP_U32: err = nvs_get_u32(handle, key.key, &scalar); break;
+    case SNAP_I32: err = nvs_get_i32(handle, key.key, (int32_t*)&scalar); break;
+    case SNAP_STR: return nvs_get_str(handle, key.key, (char*)out, &length);
+    default:       return nvs_get_blob(handle, key.key, out, &length);
+  }
+  if (err != ESP_OK) return err;
+  length = key.size;
+  if (out) memcpy(out, &scalar, key.size);
+  return ESP_OK;
+}
+
+// Deux passages : tailles, puis copie dans un tampon de la taille exacte.
+// Les statistiques sont celles de la dernière sauvegarde (STATS_SAVE_INTERVAL).
+uint8_t* snapshotExport(uint16_t sections, size_t& size) {
+  sections &= SNAPSHOT_ANY;
+
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(stateNamespace(), NVS_READONLY, &handle);
+  if (err != ESP_OK) {
+    LOG_E("✗ Snapshot export failed: %s", esp_err_to_name(err));
+    return nullptr;
+  }
+
+  size_t lengths[SNAPSHOT_KEY_COUNT];
+  size = sizeof(SnapshotHeader);
+  for (size_t k = 0; k < SNAPSHOT_KEY_COUNT; k++) {
+    lengths[k] = 0;
+    if (!(snapshotKeys[k].section & sections)) continue;
+    if (readEntry(handle, snapshotKeys[k], nullptr, lengths[k]) != ESP_OK) {
+      lengths[k] = 0;  // Absente : valeur par défaut à la restauration
+      continue;
+    }
+    size += sizeof(SnapshotEntry) + strlen(snapshotKeys[k].key) + lengths[k];
+  }
+
+  uint8_t* buffer = size <= SNAPSHOT_MAX_SIZE ? (uint8_t*)psramMalloc(size) : nullptr;
+  if (!buffer) {
+    nvs_close(handle);
+    LOG_E("✗ Snapshot export failed: %u bytes", size);
+    return nullptr;
+  }
+
+  uint8_t* cursor = buffer + sizeof(SnapshotHeader);
+  for (size_t k = 0; k < SNAPSHOT_KEY_COUNT && err == ESP_OK; k++) {
+    if (lengths[k] == 0) continue;
+    const SnapshotKey& key = snapshotKeys[k];
+    SnapshotEntry entry = {key.type, (uint8_t)strlen(key.key), (uint32_t)lengths[k]};
+    memcpy(cursor, &entry, sizeof(entry));
+    memcpy(cursor + sizeof(entry), key.key, entry.keyLength);
+    cursor += sizeof(entry) + entry.keyLength;
+
+    // Entrée réécrite entre les deux passages : export à refaire
+    size_t length = lengths[k];
+    err = readEntry(handle, key, cursor, length);
+    if (err == ESP_OK && length != lengths[k]) err = ESP_ERR_NVS_INVALID_LENGTH;
+    cursor += lengths[k];
+  }
+  nvs_close(handle);
+
+  if (err != ESP_OK) {
+    psramFree(buffer);
+    LOG_E("✗ Snapshot export failed: %s", esp_err_to_name(err));
+    return nullptr;
+  }
+
+  SnapshotHeader header;
+  header.magic = SNAPSHOT_MAGIC;
+  header.version = SNAPSHOT_VERSION;
+  header.sections = sections;
+  header.size = size;
+  header.crc = crc32_le(0, buffer + sizeof(header), size - sizeof(header));
+  memcpy(buffer, &header, sizeof(header));
+
+  LOG_I("✓ Snapshot exported (%u bytes, sections 0x%02X)", size, sections);
+  return buffer;
+}
+
+// ===== VALIDATION =====
+static bool entryValid(const SnapshotKey& key, const SnapshotEntry& entry, const uint8_t* data) {
+  if (entry.type != key.type || entry.length == 0) return false;
+  switch (key.type) {
+    case SNAP_STR:
+      return entry.length <= key.size && data[entry.length - 1] == '\0' &&
+             strlen((const char*)data) == entry.length - 1;
+    case SNAP_BLOB:
+      return key.size == 0 || entry.length == key.size;
+    default:
+      return entry.length == key.size;
+  }
+}
+
+// En-tête, CRC, puis chaque entrée : clé connue, de type et de taille attendus
+static bool parseSnapshot(const uint8_t* data, size_t size, EntryRef* entries,
+                          uint16_t& sections, const char*& error) {
+  SnapshotHeader header;
+  if (size < sizeof(header)) {
+    error = "Instantané tronqué";
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != SNAPSHOT_MAGIC) {
+    error = "Format d'instantané inconnu";
+    return false;
+  }
+  if (header.version != SNAPSHOT_VERSION) {
+    error = "Version d'instantané non prise en charge";
+    return false;
+  }
+  if (header.size != size) {
+    error = "Instantané tronqué";
+    return false;
+  }
+  if (crc32_le(0, data + sizeof(header), size - sizeof(header)) != header.crc) {
+    error = "CRC invalide";
+    return false;
+  }
+  sections = header.sections & SNAPSHOT_ANY;
+
+  memset(entries, 0, sizeof(EntryRef) * SNAPSHOT_KEY_COUNT);
+  size_t offset = sizeof(header);
+  while (offset < size) {
+    SnapshotEntry entry;
+    if (size - offset < sizeof(entry)) {
+      error = "Entrée tronquée";
+      return false;
+    }
+    memcpy(&entry, data + offset, sizeof(entry));
+    offset += sizeof(entry);
+    if (size - offset < entry.keyLength || size - offset - entry.keyLength < entry.length) {
+      error = "Entrée tronquée";
+      return false;
+    }
+
+    int k = findKey((const char*)data + offset, entry.keyLength);
+    offset += entry.keyLength;
+    if (k < 0 || !(snapshotKeys[k].section & sections) || entries[k].data) {
+      error = "Entrée inconnue ou en double";
+      return false;
+    }
+    if (!entryValid(snapshotKeys[k], entry, data + offset)) {
+      LOG_W("Snapshot entry %s: bad type or size (%lu bytes)", snapshotKeys[k].key, entry.length);
+      error = "Entrée de type ou de taille invalide";
+      return false;
+    }
+    entries[k].data = data + offset;
+    entries[k].length = entry.length;
+    offset += entry.length;
+  }
+  return true;
+}
+
+// Blob de la table complet (CRC, références de noms) et à la capacité de
+// cet appareil (allouée au démarrage)
+static bool codesValid(const EntryRef* entries, const char*& error) {
+  const EntryRef& table = entryFor(entries, "codeTable");
+  if (!table.data) return true;
+  uint32_t count = 0;
+  if (!checkCodeTableBlob(table.data, table.length, count, error)) return false;
+  if (count > (uint32_t)accessCodeCapacity) {
+    error = "Trop de codes pour la capacité de cet appareil";
+    return false;
+  }
+  return true;
+}
+
+// ===== RESTAURATION =====
+#define NVS_ENTRY_SIZE    32
+#define NVS_PAGE_ENTRIES  126   // Entrées de données par page de 4 Ko
+
+static esp_err_t writeEntry(nvs_handle_t handle, const SnapshotKey& key, const EntryRef& entry) {
+  uint32_t scalar = 0;
+  if (key.type != SNAP_STR && key.type != SNAP_BLOB) memcpy(&scalar, entry.data, key.size);
+  switch (key.type) {
+    case SNAP_U8:  return nvs_set_u8(handle, key.key, (uint8_t)scalar);
+    case SNAP_U16: return nvs_set_u16(handle, key.key, (uint16_t)scalar);
+    case SNAP_U32: return nvs_set_u32(handle, key.key, scalar);
+    case SNAP_I32: return nvs_set_i32(handle, key.key, (int32_t)scalar);
+    case SNAP_STR: return nvs_set_str(handle, key.key, (const char*)entry.data);
+    default:       return nvs_set_blob(handle, key.key, entry.data, entry.length);
+  }
+}
+
+// Entrées NVS occupées par une valeur : en-tête, données, et pour un blob
+// un en-tête par morceau (un morceau par page) plus un index
+static size_t nvsEntriesFor(nvs_type_t type, size_t length) {
+  if (type != NVS_TYPE_STR && type != NVS_TYPE_BLOB) return 1;
+  size_t entries = 1 + (length + NVS_ENTRY_SIZE - 1) / NVS_ENTRY_SIZE;
+  if (type == NVS_TYPE_BLOB) entries += 1 + length / (NVS_PAGE_ENTRIES * NVS_ENTRY_SIZE);
+  return entries;
+}
+
+static nvs_type_t nvsTypeOf(const SnapshotKey& key) {
+  if (key.type == SNAP_STR) return NVS_TYPE_STR;
+  if (key.type == SNAP_BLOB) return NVS_TYPE_BLOB;
+  return NVS_TYPE_U32;  // Une entrée, comme tout entier
+}
+
+#define COPY_SCALAR(T, suffix) { \
+    T value; \
+    err = nvs_get_##suffix(from, info.key, &value); \
+    if (err == ESP_OK && to) err = nvs_set_##suffix(to, info.key, value); \
+    break; \
+  }
+
+// Copie une entrée de l'espace actif quel que soit son type (compteurs
+// moteur, plancher anti-rejeu, ...). `to` nul : place nécessaire seulement.
+static esp_err_t copyEntry(nvs_handle_t from, nvs_handle_t to, const nvs_entry_info_t& info,
+                           size_t& entries) {
+  esp_err_t err = ESP_OK;
+  size_t length = 0;
+  switch (info.type) {
+    case NVS_TYPE_U8:  COPY_SCALAR(uint8_t, u8)
+    case NVS_TYPE_I8:  COPY_SCALAR(int8_t, i8)
+    case NVS_TYPE_U16: COPY_SCALAR(uint16_t, u16)
+    case NVS_TYPE_I16: COPY_SCALAR(int16_t, i16)
+    case NVS_TYPE_U32: COPY_SCALAR(uint32_t, u32)
+    case NVS_TYPE_I32: COPY_SCALAR(int32_t, i32)
+    case NVS_TYPE_U64: COPY_SCALAR(uint64_t, u64)
+    case NVS_TYPE_I64: COPY_SCALAR(int64_t, i64)
+    case NVS_TYPE_STR:
+    case NVS_TYPE_BLOB: {
+      bool blob = info.type == NVS_TYPE_BLOB;
+      err = blob ? nvs_get_blob(from, info.key, nullptr, &length)
+                 : nvs_get_str(from, info.key, nullptr, &length);
+      if (err != ESP_OK || !to) break;
+      uint8_t* value = (uint8_t*)psramMalloc(length ? length : 1);
+      if (!value) return ESP_ERR_NO_MEM;
+      err = blob ? nvs_get_blob(from, info.key, value, &length)
+                 : nvs_get_str(from, info.key, (char*)value, &length);
+      if (err == ESP_OK) {
+        err = blob ? nvs_set_blob(to, info.key, value, length)
+                   : nvs_set_str(to, info.key, (const char*)value);
+      }
+      psramFree(value);
+      break;
+    }
+    default:
+      return ESP_OK;
+  }
+  entries += nvsEntriesFor(info.type, length);
+  return err;
+}
+
+#undef COPY_SCALAR
+
+// Entrées de l'espace actif reprises telles quelles, sauf celles des sections
+// restaurées : prises dans l'instantané, ou absentes (valeur par défaut)
+static esp_err_t fillNamespace(nvs_handle_t from, nvs_handle_t to, const EntryRef* entries,
+                               uint16_t selected, size_t& needed) {
+  esp_err_t err = ESP_OK;
+  nvs_iterator_t it = nvs_entry_find(NVS_DEFAULT_PART_NAME, stateNamespace(), NVS_TYPE_ANY);
+  while (it && err == ESP_OK) {
+    nvs_entry_info_t info;
+    nvs_entry_info(it, &info);
+    int k = findKey(info.key, strlen(info.key));
+    if (k < 0 || !(snapshotKeys[k].section & selected)) err = copyEntry(from, to, info, needed);
+    it = nvs_entry_next(it);
+  }
+  if (it) nvs_release_iterator(it);
+
+  for (size_t k = 0; k < SNAPSHOT_KEY_COUNT && err == ESP_OK; k++) {
+    const SnapshotKey& key = snapshotKeys[k];
+    if (!(key.section & selected) || !entries[k].data) continue;
+    needed += nvsEntriesFor(nvsTypeOf(key), entries[k].length);
+    if (to) err = writeEntry(to, key, entries[k]);
+  }
+  return err;
+}
+
+// Tables en RAM relues depuis le nouvel espace
+static void reloadSections(uint16_t sections) {
+  if (sections & (SNAPSHOT_CONFIG | SNAPSHOT_CREDENTIALS)) {
+    Config previous = config;
+    loadConfig();
+    loadDoors();
+    if (strcmp(previous.timezone, config.timezone) != 0) {
+      configTzTime(config.timezone, "pool.ntp.org", "time.google.com");
+    }
+    if (strcmp(previous.adminPassword, config.adminPassword) != 0) authPasswordChanged();
+  }
+  if (sections & SNAPSHOT_CODES) loadAccessCodes();
+  if (sections & SNAPSHOT_GROUPS) loadGroups();
+  if (sections & SNAPSHOT_SCHEDULES) loadSchedules();
+  if (sections & SNAPSHOT_STATS) loadStats();
+}
+
+// Instantané complet et cohérent pour les sections demandées, sans écriture
+static bool validateSnapshot(const uint8_t* data, size_t size, uint16_t sections,
+                             EntryRef* entries, uint16_t& selected, const char*& error) {
+  uint16_t present = 0;
+  if (!parseSnapshot(data, size, entries, present, error)) {
+    LOG_W("✗ Snapshot rejected: %s", error);
+    return false;
+  }
+  selected = sections & present;
+  if (selected == 0) {
+    error = "Aucune section à restaurer";
+    return false;
+  }
+  if ((selected & SNAPSHOT_CODES) && !codesValid(entries, error)) {
+    LOG_W("✗ Snapshot rejected: %s", error);
+    return false;
+  }
+  return true;
+}
+
+bool snapshotCheck(const uint8_t* data, size_t size, uint16_t sections, const char*& error) {
+  EntryRef entries[SNAPSHOT_KEY_COUNT];
+  uint16_t selected = 0;
+  return validateSnapshot(data, size, sections, entries, selected, error);
+}
+
+bool snapshotRestore(const uint8_t* data, size_t size, uint16_t sections,
+                     uint16_t& applied, const char*& error) {
+  EntryRef entries[SNAPSHOT_KEY_COUNT];
+  uint16_t selected = 0;
+  applied = 0;
+
+  if (!validateSnapshot(data, size, sections, entries, selected, error)) return false;
+
+  const char* previous = stateNamespace();
+  const char* target = stateNamespaces[activeGeneration ^ 1];
+  eraseNamespace(target);
+
+  nvs_handle_t from;
+  esp_err_t err = nvs_open(previous, NVS_READONLY, &from);
+  if (err != ESP_OK) {
+    LOG_E("✗ Snapshot restore failed: %s", esp_err_to_name(err));
+    error = "Lecture de la flash impossible";
+    return false;
+  }
+
+  // Place libre vérifiée avant toute écriture, une page gardée pour le
+  // recyclage de NVS
+  size_t needed = NVS_PAGE_ENTRIES;
+  nvs_stats_t stats;
+  err = fillNamespace(from, 0, entries, selected, needed);
+  if (err == ESP_OK) err = nvs_get_stats(NULL, &stats);
+  if (err == ESP_OK && stats.free_entries < needed) {
+    nvs_close(from);
+    LOG_W("✗ Snapshot restore: %u NVS entries needed, %u free", needed, stats.free_entries);
+    error = "Espace flash insuffisant";
+    return false;
+  }
+
+  // Espace inactif rempli et validé, puis bascule en une seule écriture
+  nvs_handle_t to;
+  if (err == ESP_OK) err = nvs_open(target, NVS_READWRITE, &to);
+  if (err == ESP_OK) {
+    size_t written = 0;
+    err = fillNamespace(from, to, entries, selected, written);
+    if (err == ESP_OK) err = nvs_commit(to);
+    nvs_close(to);
+  }
+  nvs_close(from);
+
+  nvs_handle_t meta;
+  if (err == ESP_OK) err = nvs_open(META_NAMESPACE, NVS_READWRITE, &meta);
+  if (err == ESP_OK) {
+    err = nvs_set_u8(meta, "active", activeGeneration ^ 1);
+    if (err == ESP_OK) err = nvs_commit(meta);
+    nvs_close(meta);
+  }
+
+  if (err != ESP_OK) {
+    eraseNamespace(target);  // État précédent intact, RAM inchangée
+    LOG_E("✗ Snapshot restore failed: %s", esp_err_to_name(err));
+    error = "Écriture en flash impossible";
+    return false;
+  }
+
+  activeGeneration ^= 1;
+  preferences.end();
+  preferences.begin(stateNamespace(), false);
+  eraseNamespace(previous);
+  reloadSections(selected);
+
+  applied = selected;
+  LOG_I("✓ Snapshot restored (%u bytes, sections 0x%02X, %d codes)", size, selected, accessCodeCount);
+  return true;
+}
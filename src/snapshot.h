@@ -0,0 +1,67 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== INSTANTANÉ DE L'ÉTAT =====
+// Sauvegarde binaire de l'état persistant, pour remplacer un contrôleur ou
+// cloner une flotte. Les entrées NVS de la liste blanche (snapshot.cpp) sont
+// copiées telles quelles : l'en-tête SnapshotHeader, puis pour chaque entrée
+// type (1 o), longueur de la clé (1 o), longueur des données (4 o), clé,
+// données. Le CRC32 couvre tout ce qui suit l'en-tête.
+// La restauration valide tout l'instantané (version, CRC, clés, tailles,
+// cohérence de la table des codes) et la place libre en flash avant la
+// moindre écriture. Elle remplit ensuite un second espace NVS (sections
+// demandées, autres entrées recopiées) et n'y bascule qu'une fois celui-ci
+// complet : un échec laisse l'état précédent intact. Les tables sont enfin
+// rechargées.
+#define SNAPSHOT_MAGIC      0x504E5352  // "RSNP"
+#define SNAPSHOT_VERSION    2           // 2 : table des codes en un seul blob
+#define SNAPSHOT_MAX_SIZE   524288      // 512 Ko, assemblé en PSRAM
+
+// Sections : restaurer un sous-ensemble (ex. codes,groups,schedules pour
+// cloner sans reprendre le topic MQTT ni les statistiques d'un autre appareil)
+#define SNAPSHOT_CONFIG     0x01  // Configuration, réglages des portes
+#define SNAPSHOT_CODES      0x02  // Table des codes, noms, groupes par code
+#define SNAPSHOT_GROUPS     0x04
+#define SNAPSHOT_SCHEDULES  0x08
+#define SNAPSHOT_STATS      0x10
+#define SNAPSHOT_ALL        0x1F  // Défaut : tout sauf les identifiants
+// Mot de passe admin (aussi clé de signature MQTT et mot de passe OTA) et
+// mot de passe MQTT : exportés seulement sur demande explicite en HTTP,
+// jamais par MQTT (tout abonné au broker lirait l'instantané)
+#define SNAPSHOT_CREDENTIALS 0x20
+#define SNAPSHOT_ANY        0x3F
+
+struct __attribute__((packed)) SnapshotHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t sections;  // Sections présentes
+  uint32_t size;      // Taille totale, en-tête compris
+  uint32_t crc;
+};
+
+// Espace NVS de l'état ("roller" ou "rollerB"), choisi par snapshotBegin()
+// avant preferences.begin() ; toute écriture de l'état passe par lui
+void snapshotBegin();
+const char* stateNamespace();
+
+// "codes,groups" -> masque ; NULL ou "" = SNAPSHOT_ALL, 0 si un nom est inconnu
+uint16_t snapshotSectionsFromText(const char* text);
+void snapshotSectionsToJson(uint16_t sections, JsonArray out);
+
+// Tampon PSRAM à libérer par psramFree, nullptr en cas d'échec.
+// Export et restauration depuis loop() seulement : ils lisent les tables
+// et rouvrent `preferences` (voir scheduler.h)
+uint8_t* snapshotExport(uint16_t sections, size_t& size);
+
+// Validation seule (format, CRC, cohérence des codes), sans toucher à l'état :
+// utilisable hors de loop() pour refuser un instantané avant de le confier
+bool snapshotCheck(const uint8_t* data, size_t size, uint16_t sections, const char*& error);
+
+// `sections` : sections à appliquer parmi celles présentes (`applied` en retour)
+bool snapshotRestore(const uint8_t* data, size_t size, uint16_t sections,
+                     uint16_t& applied, const char*& error);
+
+#endif
@@ -0,0 +1,194 @@
+#include "stats.h"
+#include "config.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include "schedule.h"
+#include <Preferences.h>
+#include <time.h>
+
+extern Preferences preferences;
+extern AccessCode* accessCodes;
+extern int accessCodeCount;
+
+static AccessStats stats;
+static CodeStats* codeStats = nullptr;  // Adressage ouvert, taille puissance de 2
+static uint32_t codeStatsSlots = 0;
+static uint32_t codeStatsUsed = 0;
+static bool statsDirty = false;
+static unsigned long lastStatsSave = 0;
+
+static uint32_t nowUnix() {
+  time_t now = time(nullptr);
+  return now >= 1700000000 ? (uint32_t)now : 0;
+}
+
+static uint32_t slotOf(uint32_t code, uint8_t type) {
+  uint32_t h = (code ^ ((uint32_t)type << 30)) * 2654435761u;  // Hachage de Knuth
+  return h & (codeStatsSlots - 1);
+}
+
+static CodeStats* findCodeStats(uint32_t code, uint8_t type, bool create) {
+  if (codeStatsSlots == 0) return nullptr;
+
+  uint32_t mask = codeStatsSlots - 1;
+  for (uint32_t slot = slotOf(code, type), probes = 0; probes < codeStatsSlots;
+       slot = (slot + 1) & mask, probes++) {
+    CodeStats& entry = codeStats[slot];
+    if (entry.used && entry.code == code && entry.type == type) return &entry;
+    if (!entry.used) {
+      // Facteur de charge max 75% : au-delà, plus de nouveaux identifiants
+      if (!create || codeStatsUsed * 4 >= codeStatsSlots * 3) return nullptr;
+      memset(&entry, 0, sizeof(entry));
+      entry.code = code;
+      entry.type = type;
+      entry.used = 1;
+      codeStatsUsed++;
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// ===== INITIALISATION / PERSISTANCE =====
+void statsBegin(int codeCapacity) {
+  codeStatsSlots = 16;
+  while (codeStatsSlots < (uint32_t)codeCapacity * 2) codeStatsSlots *= 2;
+  codeStats = (CodeStats*)psramCalloc(codeStatsSlots, sizeof(CodeStats));
+  if (!codeStats) codeStatsSlots = 0;
+  loadStats();
+}
+
+// Relecture complète (démarrage, restauration d'un instantané)
+void loadStats() {
+  if (codeStats) memset(codeStats, 0, codeStatsSlots * sizeof(CodeStats));
+  codeStatsUsed = 0;
+  statsDirty = false;
+
+  if (preferences.getBytes("stats", &stats, sizeof(stats)) != sizeof(stats)) {
+    memset(&stats, 0, sizeof(stats));
+  }
+
+  // Compteurs par identifiant : liste compacte des entrées utilisées
+  size_t len = preferences.getBytesLength("statsCodes");
+  if (len > 0 && len % sizeof(CodeStats) == 0 && codeStats) {
+    CodeStats* saved = (CodeStats*)psramMalloc(len);
+    if (saved) {
+      preferences.getBytes("statsCodes", saved, len);
+      for (size_t i = 0; i < len / sizeof(CodeStats); i++) {
+        CodeStats* entry = findCodeStats(saved[i].code, saved[i].type, true);
+        if (entry) *entry = saved[i];
+      }
+      psramFree(saved);
+    }
+  }
+
+  lastStatsSave = millis();
+  LOG_I("✓ Stats loaded (%u credential counters)", codeStatsUsed);
+}
+
+// Seuls les identifiants encore présents dans la table sont conservés :
+// la sauvegarde purge les compteurs des codes supprimés
+void saveStats() {
+  preferences.putBytes("stats", &stats, sizeof(stats));
+
+  if (codeStats) {
+    CodeStats* kept = (CodeStats*)psramMalloc((accessCodeCount ? accessCodeCount : 1) * sizeof(CodeStats));
+    if (kept) {
+      int count = 0;
+      for (int i = 0; i < accessCodeCount; i++) {
+        CodeStats* entry = findCodeStats(accessCodes[i].code, accessCodes[i].type, false);
+        if (entry) kept[count++] = *entry;
+      }
+
+      memset(codeStats, 0, codeStatsSlots * sizeof(CodeStats));
+      codeStatsUsed = 0;
+      for (int i = 0; i < count; i++) *findCodeStats(kept[i].code, kept[i].type, true) = kept[i];
+
+      if (count > 0) {
+        preferences.putBytes("statsCodes", kept, count * sizeof(CodeStats));
+      } else {
+        preferences.remove("statsCodes");
+      }
+      psramFree(kept);
+    }
+  }
+
+  statsDirty = false;
+  lastStatsSave = millis();
+  LOG_D("Stats saved to flash (%u credential counters)", codeStatsUsed);
+}
+
+void statsLoop() {
+  if (statsDirty && millis() - lastStatsSave >= STATS_SAVE_INTERVAL) saveStats();
+}
+
+void resetStats() {
+  memset(&stats, 0, sizeof(stats));
+  stats.since = nowUnix();
+  if (codeStats) memset(codeStats, 0, codeStatsSlots * sizeof(CodeStats));
+  codeStatsUsed = 0;
+  saveStats();
+  LOG_I("✓ Stats reset");
+}
+
+// ===== MISE À JOUR =====
+void statsRecordAccess(uint32_t code, uint8_t type, bool granted, bool known) {
+  if (type > 2) return;
+
+  uint16_t slot = currentScheduleSlot();  // Heure déjà calculée pour les plages
+  int hour = slot == SCHEDULE_NO_CLOCK ? -1 : (slot % SCHEDULE_SLOTS_DAY) / 4;
+
+  if (granted) {
+    stats.grants[type]++;
+    if (hour >= 0) stats.grantsByHour[hour]++;
+  } else {
+    stats.denies[type]++;
+    if (hour >= 0) stats.deniesByHour[hour]++;
+    if (!known) stats.unknownDenies++;
+  }
+
+  // Compteurs par identifiant : uniquement pour les codes de la table
+  if (known) {
+    CodeStats* entry = findCodeStats(code, type, true);
+    if (entry) {
+      if (granted) {
+        entry->uses++;
+      } else {
+        entry->denies++;
+      }
+      entry->lastSeen = nowUnix();
+    }
+  }
+  statsDirty = true;
+}
+
+const CodeStats* statsForCode(uint32_t code, uint8_t type) {
+  return findCodeStats(code, type, false);
+}
+
+// ===== EXPORT =====
+void statsToJson(JsonObject out) {
+  static const char* typeNames[] = {"keypad", "rfid", "fingerprint"};
+
+  uint32_t grants = 0, denies = 0;
+  JsonObject byType = out["byType"].to<JsonObject>();
+  for (int t = 0; t < 3; t++) {
+    JsonObject entry = byType[typeNames[t]].to<JsonObject>();
+    entry["granted"] = stats.grants[t];
+    entry["denied"] = stats.denies[t];
+    grants += stats.grants[t];
+    denies += stats.denies[t];
+  }
+  out["granted"] = grants;
+  out["denied"] = denies;
+  out["unknownDenied"] = stats.unknownDenies;
+  out["since"] = stats.since;
+
+  JsonArray grantsByHour = out["grantsByHour"].to<JsonArray>();
+  JsonArray deniesByHour = out["deniesByHour"].to<JsonArray>();
+  for (int h = 0; h < 24; h++) {
+    grantsByHour.add(stats.grantsByHour[h]);
+    deniesByHour.add(stats.deniesByHour[h]);
+  }
+  out["trackedCredentials"] = codeStatsUsed;
+}
@@ -0,0 +1,42 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ===== STATISTIQUES D'ACCÈS =====
+// Agrégats mis à jour en O(1) à chaque accès (addAccessLog), sans relire
+// l'historique : compteurs par type, histogramme par heure de la journée,
+// et par identifiant (utilisations, refus, dernier passage) dans une table
+// de hachage indexée par (code, type). Sauvegardés toutes les
+// STATS_SAVE_INTERVAL ms s'ils ont changé.
+#define STATS_SAVE_INTERVAL  600000  // 10 minutes
+
+struct CodeStats {
+  uint32_t code;
+  uint32_t uses;
+  uint32_t denies;
+  uint32_t lastSeen;  // Heure Unix, 0 si l'horloge n'était pas synchronisée
+  uint8_t type;
+  uint8_t used;
+};
+
+struct AccessStats {
+  uint32_t grants[3];        // Par type (0=Keypad, 1=RFID, 2=Fingerprint)
+  uint32_t denies[3];
+  uint32_t grantsByHour[24]; // Heure locale (si l'horloge est synchronisée)
+  uint32_t deniesByHour[24];
+  uint32_t unknownDenies;    // Identifiants absents de la table
+  uint32_t since;            // Heure Unix de la dernière remise à zéro
+};
+
+void statsBegin(int codeCapacity);
+void loadStats();
+void statsRecordAccess(uint32_t code, uint8_t type, bool granted, bool known);
+const CodeStats* statsForCode(uint32_t code, uint8_t type);
+void statsLoop();
+void saveStats();
+void resetStats();
+void statsToJson(JsonObject out);
+
+#endif
@@ -0,0 +1,137 @@
+#include "switches.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "logger.h"
+#include "scheduler.h"
+#include <atomic>
+
+enum SwitchPhase : uint8_t {
+  SWITCH_RELEASED,
+  SWITCH_PRESSED,  // Appui en cours, pas encore un maintien
+  SWITCH_HELD      // Maintien : arrêt au relâchement
+};
+
+// `presses` compte les appuis vus par l'interruption : premier front bas
+// après un silence d'au moins SWITCH_DEBOUNCE_MS (les rebonds sont ignorés)
+struct ManualSwitch {
+  int8_t pin;
+  uint8_t door;
+  bool open;
+  std::atomic<uint32_t> lastEdge;
+  std::atomic<uint8_t> presses;
+  std::atomic<bool> edge;
+  SwitchPhase phase;
+  bool stopping;  // Cet appui a arrêté la porte : rien à faire au relâchement
+  unsigned long pressedAt;
+};
+
+static ManualSwitch switches[MAX_DOORS * 2];
+static uint8_t switchCount = 0;
+
+static void IRAM_ATTR onSwitchEdge(void* arg) {
+  ManualSwitch* sw = (ManualSwitch*)arg;
+  uint32_t now = millis();
+
+  if (digitalRead(sw->pin) == LOW && now - sw->lastEdge.load(std::memory_order_relaxed) >= SWITCH_DEBOUNCE_MS) {
+    sw->presses.fetch_add(1, std::memory_order_relaxed);
+  }
+  sw->lastEdge.store(now, std::memory_order_relaxed);
+  sw->edge.store(true, std::memory_order_release);
+  schedulerPostFromISR(EVENT_SWITCHES);
+}
+
+void switchesBegin() {
+  switchCount = 0;
+  for (uint8_t d = 0; d < doorCount; d++) {
+    const int8_t pins[2] = {doorPins[d].upSwitch, doorPins[d].downSwitch};
+    for (uint8_t i = 0; i < 2; i++) {
+      if (pins[i] == PIN_NONE) continue;
+
+      ManualSwitch& sw = switches[switchCount++];
+      sw.pin = pins[i];
+      sw.door = d;
+      sw.open = i == 0;
+      sw.lastEdge.store(0);
+      sw.presses.store(0);
+      sw.edge.store(false);
+      sw.phase = SWITCH_RELEASED;
+
+      pinMode(sw.pin, INPUT_PULLUP);
+      attachInterruptArg(digitalPinToInterrupt(sw.pin), onSwitchEdge, &sw, CHANGE);
+    }
+  }
+  LOG_I("✓ %u manual switch(es) on interrupts", switchCount);
+}
+
+// ===== ÉVÉNEMENTS =====
+static void onPress(ManualSwitch& sw, unsigned long now) {
+  sw.phase = SWITCH_PRESSED;
+  sw.pressedAt = now;
+  sw.stopping = doors[sw.door].phase != DOOR_IDLE;
+
+  if (sw.stopping) {
+    LOG_I("Manual switch: STOP (door %u)", sw.door);
+    submitDoorCommand(sw.door, DOOR_TARGET_STOP, SOURCE_MANUAL);
+  } else {
+    LOG_I("Manual switch: %s (door %u)", sw.open ? "OPEN" : "CLOSE", sw.door);
+    submitDoorCommand(sw.door, sw.open ? 100 : 0, SOURCE_MANUAL);
+  }
+}
+
+static void onRelease(ManualSwitch& sw) {
+  if (sw.phase == SWITCH_HELD && !sw.stopping) {
+    LOG_I("Manual switch released: STOP (door %u)", sw.door);
+    submitDoorCommand(sw.door, DOOR_TARGET_STOP, SOURCE_MANUAL);
+  }
+  sw.phase = SWITCH_RELEASED;
+}
+
+// ===== MACHINES D'ÉTATS =====
+static void stepSwitch(ManualSwitch& sw, unsigned long now) {
+  // Appui signalé par l'interruption : traité tout de suite, même déjà relâché
+  if (sw.presses.exchange(0) > 0 && sw.phase == SWITCH_RELEASED) onPress(sw, now);
+
+  // Niveau relu seulement une fois les rebonds terminés
+  if (sw.edge.load(std::memory_order_acquire)) {
+    uint32_t lastEdge = sw.lastEdge.load(std::memory_order_relaxed);
+    if (now - lastEdge >= SWITCH_DEBOUNCE_MS) {
+      sw.edge.store(false);
+      if (sw.lastEdge.load(std::memory_order_relaxed) != lastEdge) {
+        sw.edge.store(true);  // Nouveau front entre-temps
+      } else {
+        bool pressed = digitalRead(sw.pin) == LOW;
+        if (pressed && sw.phase == SWITCH_RELEASED) {
+          onPress(sw, now);
+        } else if (!pressed && sw.phase != SWITCH_RELEASED) {
+          onRelease(sw);
+        }
+      }
+    }
+  }
+
+  if (sw.phase == SWITCH_PRESSED && now - sw.pressedAt >= SWITCH_HOLD_MS) {
+    sw.phase = SWITCH_HELD;
+    LOG_D("Manual switch held: hold-to-run (door %u)", sw.door);
+  }
+}
+
+void switchesUpdate() {
+  unsigned long now = millis();
+  uint32_t wake = UINT32_MAX;
+
+  for (uint8_t i = 0; i < switchCount; i++) {
+    ManualSwitch& sw = switches[i];
+    stepSwitch(sw, now);
+
+    // Prochaine échéance : fin des rebonds, ou passage en maintien
+    if (sw.edge.load()) {
+      uint32_t quiet = now - sw.lastEdge.load();
+      wake = min(wake, quiet >= SWITCH_DEBOUNCE_MS ? 0 : SWITCH_DEBOUNCE_MS - quiet);
+    }
+    if (sw.phase == SWITCH_PRESSED) {
+      uint32_t held = now - sw.pressedAt;
+      wake = min(wake, held >= SWITCH_HOLD_MS ? 0 : SWITCH_HOLD_MS - held);
+    }
+  }
+  if (wake != UINT32_MAX) timerArm(TIMER_SWITCHES, wake);
+}
@@ -0,0 +1,22 @@
+#ifndef SWITCHES_H
+#define SWITCHES_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== INTERRUPTEURS MANUELS =====
+// Une interruption par front sur chaque interrupteur (montée/descente de
+// chaque porte) : un appui plus court qu'un tour de boucle n'est pas perdu.
+// switchesUpdate() fait avancer une machine d'états par interrupteur sans
+// relire les broches tant qu'aucun front n'est arrivé :
+//  - appui, porte à l'arrêt : course complète dans le sens du bouton ;
+//  - appui, porte en mouvement : stop (appui court = arrêt) ;
+//  - maintien au-delà de SWITCH_HOLD_MS : le moteur tourne tant que le
+//    bouton est tenu et s'arrête au relâchement.
+#define SWITCH_DEBOUNCE_MS  30
+#define SWITCH_HOLD_MS      700
+
+void switchesBegin();
+void switchesUpdate();
+
+#endif
@@ -0,0 +1,94 @@
+#include "timer_wheel.h"
+#include <string.h>
+
+struct WheelTimer {
+  uint32_t expires;  // En ticks absolus
+  int8_t next;
+  int8_t prev;
+  bool armed;
+};
+
+static WheelTimer timers[TIMER_COUNT];
+static int8_t slots[SCHEDULER_WHEEL_SLOTS];
+static uint32_t currentTick = 0;
+static TickSource nowTick = nullptr;
+
+void timerWheelBegin(TickSource source) {
+  nowTick = source;
+  memset(slots, -1, sizeof(slots));
+  for (uint8_t i = 0; i < TIMER_COUNT; i++) timers[i].armed = false;
+  currentTick = nowTick();
+}
+
+static void unlink(uint8_t id) {
+  WheelTimer& timer = timers[id];
+  if (!timer.armed) return;
+
+  if (timer.prev >= 0) {
+    timers[timer.prev].next = timer.next;
+  } else {
+    slots[timer.expires % SCHEDULER_WHEEL_SLOTS] = timer.next;
+  }
+  if (timer.next >= 0) timers[timer.next].prev = timer.prev;
+  timer.armed = false;
+}
+
+// Réarmer remplace l'échéance précédente
+void timerArm(TimerId id, uint32_t delayMs) {
+  unlink(id);
+
+  WheelTimer& timer = timers[id];
+  uint32_t ticks = (delayMs + SCHEDULER_TICK_MS - 1) / SCHEDULER_TICK_MS;
+  timer.expires = nowTick() + (ticks ? ticks : 1);
+
+  int8_t& head = slots[timer.expires % SCHEDULER_WHEEL_SLOTS];
+  timer.prev = -1;
+  timer.next = head;
+  if (head >= 0) timers[head].prev = id;
+  head = id;
+  timer.armed = true;
+}
+
+void timerCancel(TimerId id) {
+  unlink(id);
+}
+
+bool timerArmed(TimerId id) {
+  return timers[id].armed;
+}
+
+// Une case par tick écoulé, au plus un tour : après une longue attente,
+// chaque case est visitée une fois et toute échéance passée est déclenchée
+uint32_t timerWheelAdvance() {
+  uint32_t target = nowTick();
+  uint32_t steps = target - currentTick;
+  if (steps > SCHEDULER_WHEEL_SLOTS) steps = SCHEDULER_WHEEL_SLOTS;
+
+  uint32_t fired = 0;
+  for (uint32_t i = 1; i <= steps; i++) {
+    int8_t id = slots[(currentTick + i) % SCHEDULER_WHEEL_SLOTS];
+    while (id >= 0) {
+      int8_t next = timers[id].next;
+      if ((int32_t)(target - timers[id].expires) >= 0) {
+        unlink(id);
+        fired |= 1u << id;
+      }
+      id = next;
+    }
+  }
+  currentTick = target;
+  return fired;
+}
+
+// Quelques temporisateurs seulement : un parcours suffit
+uint32_t timerWheelNextDeadlineMs() {
+  uint32_t now = nowTick();
+  uint32_t best = SCHEDULER_HOUSEKEEPING_MS / SCHEDULER_TICK_MS;
+  for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+    if (!timers[i].armed) continue;
+    int32_t remaining = (int32_t)(timers[i].expires - now);
+    if (remaining <= 0) return 0;
+    if ((uint32_t)remaining < best) best = remaining;
+  }
+  return best * SCHEDULER_TICK_MS;
+}
@@ -0,0 +1,38 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+// ===== ROUE DE TEMPORISATION =====
+// Un temporisateur fixe par composant, chaîné dans la case
+// (échéance % SCHEDULER_WHEEL_SLOTS). Les échéances au-delà d'un tour
+// restent dans leur case jusqu'au bon tour. Sans dépendance à l'ESP32 :
+// l'horloge est fournie par timerWheelBegin() (esp_timer sur la carte,
+// horloge simulée dans les tests natifs, voir test/).
+#define SCHEDULER_TICK_MS      10
+#define SCHEDULER_WHEEL_SLOTS  256   // 2,56 s par tour de roue
+#define SCHEDULER_HOUSEKEEPING_MS  1000
+
+enum TimerId : uint8_t {
+  TIMER_READERS,       // Fin de trame, timeouts clavier/apprentissage, LEDs
+  TIMER_SWITCHES,      // Anti-rebond et maintien des interrupteurs
+  TIMER_DOORS,         // Temps mort, fin de course, surveillance barrière
+  TIMER_MQTT,          // Boucle et reconnexion MQTT
+  TIMER_RESET_WINDOW,  // Fin de la fenêtre du triple appui BOOT
+  TIMER_HOUSEKEEPING,  // Sauvegardes périodiques et filet de sécurité
+  TIMER_COUNT
+};
+
+typedef uint32_t (*TickSource)();  // Ticks de SCHEDULER_TICK_MS, sans saut
+
+void timerWheelBegin(TickSource source);
+void timerArm(TimerId id, uint32_t delayMs);  // Depuis loop() uniquement
+void timerCancel(TimerId id);
+bool timerArmed(TimerId id);
+
+// Avance jusqu'à maintenant : bit (1 << TimerId) par temporisateur échu
+uint32_t timerWheelAdvance();
+// Délai avant la prochaine échéance, SCHEDULER_HOUSEKEEPING_MS au plus
+uint32_t timerWheelNextDeadlineMs();
+
+#endif
@@ -1,27 +1,190 @@
 #include "web_server.h"
 #include "config.h"
+#include "logger.h"
+#include "psram_alloc.h"
+#include "schedule.h"
+#include "groups.h"
+#include "doors.h"
+#include "door_commands.h"
+#include "code_sync.h"
+#include "batch.h"
+#include "code_index.h"
+#include "stats.h"
+#include "metrics.h"
+#include "boot.h"
+#include "network.h"
+#include "events.h"
+#include "keypad.h"
+#include "admission.h"
+#include "auth.h"
+#include "json_body.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include <memory>
 #include <ElegantOTA.h>
 #include <PubSubClient.h>
 
 extern Config config;
-extern AccessCode accessCodes[];
-extern AccessLog accessLogs[];
+extern AccessCode* accessCodes;
+extern uint16_t* accessCodeGroups;
+extern AccessLog* accessLogs;
+extern int accessCodeCapacity;
+extern int accessLogCapacity;
 extern int accessCodeCount;
 extern int logIndex;
 extern PubSubClient mqttClient;
 
-extern void saveConfig();
-extern void saveAccessCodes();
-extern void activateRelay(bool open);
-extern void deactivateRelay();
+extern size_t saveConfig(int* changedFields = nullptr);
+extern bool saveAccessCodes();
 extern bool deleteAccessCode(int index);
+extern bool addNewAccessCode(uint32_t code, uint8_t type, const char* name, uint8_t schedule = 0,
+                             uint16_t groups = GROUP_DEFAULT_MASK);
+extern bool setAccessCodeSchedule(uint32_t code, uint8_t type, uint8_t schedule);
+extern bool setAccessCodeGroups(uint32_t code, uint8_t type, uint16_t groups);
+extern const char* accessCodeName(int index);
+extern bool startBatchLearning(uint8_t type, const char* nameTemplate, uint16_t count,
+                               unsigned long timeoutMs, uint16_t firstNumber);
+extern void stopLearningMode();
+extern bool learningMode;
+extern bool learningBatch;
+extern uint8_t learningType;
+extern uint16_t learningTarget;
+extern uint16_t learningEnrolled;
+
+// Réponse d'erreur avec un message construit à l'exécution
+static void sendError(AsyncWebServerRequest *request, int status, const char* message) {
+  JsonDocument doc;
+  doc["error"] = message;
+  String body;
+  serializeJson(doc, body);
+  request->send(status, "application/json", body);
+}
+
+// Table des codes, pool de noms et apprentissage : lus et modifiés dans
+// loop() seulement (voir scheduler.h), le gestionnaire attend le résultat.
+// Faux, 503 déjà envoyée, si loop() n'a pas pris l'appel à temps.
+static bool runInLoop(AsyncWebServerRequest *request, const std::function<void()>& job) {
+  if (schedulerCall(job)) return true;
+  request->send(503, "application/json", "{\"error\":\"Contrôleur occupé, réessayer\"}");
+  return false;
+}
+
+// Seuls les champs présents dans le JSON sont modifiés (en RAM, sans écriture)
+bool applyConfigPatch(JsonVariant doc, const char*& error) {
+  if (doc["relayDuration"].is<unsigned long>()) {
+    unsigned long duration = doc["relayDuration"];
+    if (duration == 0) {
+      error = "Durée relais invalide";
+      return false;
+    }
+    config.relayDuration = duration;
+  }
+  if (doc["photoEnabled"].is<bool>())
+    config.photoBarrierEnabled = doc["photoEnabled"];
+  if (doc["mqttPort"].is<int>())
+    config.mqttPort = doc["mqttPort"];
+  
+  if (doc["mqttServer"].is<const char*>()) 
+    strlcpy(config.mqttServer, doc["mqttServer"], sizeof(config.mqttServer));
+  if (doc["mqttUser"].is<const char*>()) 
+    strlcpy(config.mqttUser, doc["mqttUser"], sizeof(config.mqttUser));
+  if (doc["mqttPassword"].is<const char*>()) 
+    strlcpy(config.mqttPassword, doc["mqttPassword"], sizeof(config.mqttPassword));
+  if (doc["mqttTopic"].is<const char*>()) 
+    strlcpy(config.mqttTopic, doc["mqttTopic"], sizeof(config.mqttTopic));
+  if (doc["adminPassword"].is<const char*>()) {
+    const char* password = doc["adminPassword"];
+    if (strlen(password) == 0 || strlen(password) >= sizeof(config.adminPassword)) {
+      error = "Mot de passe admin invalide (1-31 caractères)";
+      return false;
+    }
+    if (strcmp(password, config.adminPassword) != 0) {
+      strlcpy(config.adminPassword, password, sizeof(config.adminPassword));
+      authPasswordChanged();  // Sessions ouvertes révoquées
+    }
+  }
+  if (doc["timezone"].is<const char*>()) {
+    strlcpy(config.timezone, doc["timezone"], sizeof(config.timezone));
+    configTzTime(config.timezone, "pool.ntp.org", "time.google.com");
+  }
+  
+  // Capacités des tables : prises en compte au prochain redémarrage
+  if (doc["maxCodes"].is<int>()) {
+    int maxCodes = constrain(doc["maxCodes"].as<int>(), 0, MAX_CODES_LIMIT);
+    int effective = maxCodes ? maxCodes
+                    : (psramFound() ? DEFAULT_MAX_CODES_PSRAM : DEFAULT_MAX_CODES_INTERNAL);
+    if (effective < accessCodeCount) {
+      error = "maxCodes inférieur au nombre de codes enregistrés";
+      return false;
+    }
+    config.maxCodes = maxCodes;
+  }
+  if (doc["maxLogs"].is<int>())
+    config.maxLogs = constrain(doc["maxLogs"].as<int>(), 0, MAX_LOGS_LIMIT);
+  
+  return true;
+}
+
+// Sections d'un instantané (?sections=codes,groups) ; les identifiants ne
+// sont exportés que s'ils sont demandés (?sections=config,credentials)
+static uint16_t requestedSections(AsyncWebServerRequest *request, uint16_t defaultSections) {
+  if (!request->hasParam("sections")) return defaultSections;
+  return snapshotSectionsFromText(request->getParam("sections")->value().c_str());
+}
+
+static void handleConfigBody(AsyncWebServerRequest *request, JsonVariant doc) {
+  const char* error = nullptr;
+  if (!applyConfigPatch(doc, error)) {
+    sendError(request, 400, error);
+    return;
+  }
+  
+  int changed = 0;
+  size_t bytes = saveConfig(&changed);
+  
+  JsonDocument response;
+  response["message"] = "Configuration enregistrée";
+  response["changed"] = changed;
+  response["bytesWritten"] = bytes;
+  
+  String body;
+  serializeJson(response, body);
+  request->send(200, "application/json", body);
+}
 
 void setupWebServer() {
+  // Limites de débit, de concurrence et de taille avant toute route
+  admissionAttach(server);
+  // Jeton de session exigé sur /api/* (sauf /api/login)
+  authAttach(server);
+  
   // Page principale
   server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
     request->send_P(200, "text/html", index_html);
   });
   
+  // API - Ouverture de session ({"password":"..."} -> {"token":"...","expiresIn":s})
+  onJsonBody(server, "/api/login", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      char token[AUTH_TOKEN_LEN + 1];
+      uint32_t retryMs = 0;
+      uint32_t ip = request->client() ? (uint32_t)request->client()->remoteIP() : 0;
+      if (!authLogin(doc["password"] | "", ip, token, sizeof(token), retryMs)) {
+        char retry[12];
+        snprintf(retry, sizeof(retry), "%lu", (retryMs + 999) / 1000);
+        AsyncWebServerResponse* response = request->beginResponse(401, "application/json",
+          "{\"error\":\"Mot de passe incorrect\"}");
+        response->addHeader("Retry-After", retry);
+        request->send(response);
+        return;
+      }
+      
+      char body[AUTH_TOKEN_LEN + 48];
+      snprintf(body, sizeof(body), "{\"token\":\"%s\",\"expiresIn\":%u}", token, AUTH_SESSION_TTL_S);
+      request->send(200, "application/json", body);
+    }
+  );
+  
   // API - Statut système
   server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request){
     JsonDocument doc;
@@ -29,78 +192,137 @@ void setupWebServer() {
     doc["barrier"] = digitalRead(PHOTO_BARRIER);
     doc["wifi"] = WiFi.status() == WL_CONNECTED;
     doc["ip"] = WiFi.localIP().toString();
+    doc["freeHeap"] = ESP.getFreeHeap();
+    doc["freePsram"] = ESP.getFreePsram();
+    doc["uptime"] = millis() / 1000;
+    bootToJson(doc["boot"].to<JsonObject>());
+    networkToJson(doc["network"].to<JsonObject>());
+    eventsToJson(doc["events"].to<JsonObject>());
+    admissionToJson(doc["admission"].to<JsonObject>());
     
     String response;
     serializeJson(doc, response);
     request->send(200, "application/json", response);
   });
   
-  // API - Contrôle relais
-  server.on("/api/relay", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-      JsonDocument doc;
-      deserializeJson(doc, (const char*)data);
+  // API - Contrôle relais ({"action":"open"}, "door" optionnel, 0 par défaut)
+  onJsonBody(server, "/api/relay", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      const char* action = doc["action"] | "";
+      int door = doc["door"] | 0;
       
-      String action = doc["action"].as<String>();
-      
-      if (action == "open") {
-        activateRelay(true);
+      if (door < 0 || door >= doorCount) {
+        request->send(400, "application/json", "{\"error\":\"Porte inconnue\"}");
+      } else if (doc["position"].is<int>()) {
+        // {"door":0,"position":40} : pourcentage d'ouverture (porte calibrée)
+        int position = doc["position"];
+        if (position >= 0 && position <= 100 && submitDoorCommand(door, position, SOURCE_REMOTE)) {
+          request->send(200, "application/json", "{\"message\":\"Déplacement en cours\"}");
+        } else {
+          request->send(400, "application/json", "{\"error\":\"Position invalide ou porte non calibrée\"}");
+        }
+      } else if (!submitDoorAction(door, action, SOURCE_REMOTE)) {
+        request->send(400, "application/json", "{\"error\":\"Action invalide\"}");
+      } else if (strcmp(action, "open") == 0) {
         request->send(200, "application/json", "{\"message\":\"Ouverture en cours\"}");
-      } else if (action == "close") {
-        activateRelay(false);
+      } else if (strcmp(action, "close") == 0) {
         request->send(200, "application/json", "{\"message\":\"Fermeture en cours\"}");
-      } else if (action == "stop") {
-        deactivateRelay();
-        request->send(200, "application/json", "{\"message\":\"Arrêt du relais\"}");
+      } else if (strcmp(action, "stop") != 0) {
+        request->send(200, "application/json", "{\"message\":\"Déplacement en cours\"}");
       } else {
-        request->send(400, "application/json", "{\"error\":\"Action invalide\"}");
+        request->send(200, "application/json", "{\"message\":\"Arrêt du relais\"}");
       }
     }
   );
   
-  // API - Récupérer les codes
-  server.on("/api/codes", HTTP_GET, [](AsyncWebServerRequest *request){
+  // API - Portes : état et réglages de chaque porte
+  server.on("/api/doors", HTTP_GET, [](AsyncWebServerRequest *request){
     JsonDocument doc;
-    JsonArray codes = doc["codes"].to<JsonArray>();
+    doorsToJson(doc["doors"].to<JsonArray>());
     
-    for (int i = 0; i < accessCodeCount; i++) {
-      JsonObject code = codes.add<JsonObject>();
-      code["code"] = accessCodes[i].code;
-      code["type"] = accessCodes[i].type;
-      code["name"] = accessCodes[i].name;
-      code["active"] = accessCodes[i].active;
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  // Réglages d'une porte : {"door":1,"name":"Portail","relayDuration":8000,"photoEnabled":true}
+  onJsonBody(server, "/api/doors", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      const char* error = nullptr;
+      if (updateDoor(doc, error)) {
+        request->send(200, "application/json", "{\"message\":\"Porte mise à jour\"}");
+      } else {
+        sendError(request, 400, error);
+      }
     }
+  );
+  
+  // API - Télémétrie moteur : temps de marche, cycles, barrière par porte
+  server.on("/api/metrics", HTTP_GET, [](AsyncWebServerRequest *request){
+    JsonDocument doc;
+    metricsToJson(doc.to<JsonObject>());
     
     String response;
     serializeJson(doc, response);
     request->send(200, "application/json", response);
   });
   
+  // Remise à zéro après remplacement d'un moteur : /api/metrics/reset?door=1 (toutes sans door)
+  server.on("/api/metrics/reset", HTTP_POST, [](AsyncWebServerRequest *request){
+    int door = request->hasParam("door") ? request->getParam("door")->value().toInt() : -1;
+    if (resetMetrics(door)) {
+      request->send(200, "application/json", "{\"success\":true}");
+    } else {
+      request->send(400, "application/json", "{\"error\":\"Porte inconnue\"}");
+    }
+  });
+  
+  // API - Récupérer les codes : /api/codes?q=&type=&active=&offset=&limit=
+  // q = préfixe du nom (insensible à la casse), résultats paginés
+  server.on("/api/codes", HTTP_GET, [](AsyncWebServerRequest *request){
+    CodeQuery query;
+    query.prefix = request->hasParam("q") ? request->getParam("q")->value().c_str() : nullptr;
+    query.type = request->hasParam("type") ? request->getParam("type")->value().toInt() : -1;
+    query.active = request->hasParam("active") ? request->getParam("active")->value().toInt() : -1;
+    query.offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+    query.limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt()
+                                             : CODE_QUERY_DEFAULT_LIMIT;
+    query.offset = max(query.offset, 0);
+    query.limit = constrain(query.limit, 1, CODE_QUERY_MAX_LIMIT);
+    
+    String response;
+    if (!runInLoop(request, [&]{
+      JsonDocument doc(&psramJsonAllocator);
+      JsonArray codes = doc["codes"].to<JsonArray>();
+      doc["total"] = searchCodes(query, codes);
+      doc["offset"] = query.offset;
+      doc["limit"] = query.limit;
+      doc["capacity"] = accessCodeCapacity;
+      serializeJson(doc, response);
+    })) return;
+    request->send(200, "application/json", response);
+  });
+  
   // API - Ajouter un code
-  server.on("/api/codes", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-      if (accessCodeCount >= 50) {
-        request->send(400, "application/json", "{\"error\":\"Limite de codes atteinte\"}");
-        return;
-      }
-      
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, (const char*)data);
-      
-      if (error) {
-        request->send(400, "application/json", "{\"error\":\"JSON invalide\"}");
-        return;
-      }
-      
-      // Validation des champs requis
-      if (!doc["code"].is<uint32_t>() || !doc["type"].is<uint8_t>() || !doc["name"].is<const char*>()) {
+  onJsonBody(server, "/api/codes", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      // Validation des champs requis ("pin" : code clavier en texte, zéros
+      // initiaux compris, à la place de "code")
+      bool hasPin = doc["pin"].is<const char*>();
+      if ((!hasPin && !doc["code"].is<uint32_t>()) || !doc["type"].is<uint8_t>() || !doc["name"].is<const char*>()) {
         request->send(400, "application/json", "{\"error\":\"Champs manquants ou invalides\"}");
         return;
       }
       
-      uint32_t code = doc["code"];
+      uint32_t code = doc["code"] | 0;
       uint8_t type = doc["type"];
+      if (hasPin && (type != 0 || !keypadKeyFromText(doc["pin"], code))) {
+        request->send(400, "application/json", "{\"error\":\"PIN invalide (1-10 chiffres, 2147483647 au plus sans zéro initial, type 0)\"}");
+        return;
+      }
       const char* name = doc["name"];
+      uint8_t schedule = doc["schedule"] | 0;
+      uint16_t groups = doc["groups"] | GROUP_DEFAULT_MASK;
       
       // Validation des valeurs
       if (code == 0) {
@@ -118,29 +340,361 @@ void setupWebServer() {
         return;
       }
       
-      // Vérifier si le code existe déjà
-      for (int i = 0; i < accessCodeCount; i++) {
-        if (accessCodes[i].code == code && accessCodes[i].type == type) {
-          request->send(400, "application/json", "{\"error\":\"Ce code existe déjà\"}");
+      int status = 200;
+      const char* result = "{\"message\":\"Code ajouté\"}";
+      if (!runInLoop(request, [&]{
+        if (accessCodeCount >= accessCodeCapacity) {
+          status = 400;
+          result = "{\"error\":\"Limite de codes atteinte\"}";
+          return;
+        }
+        
+        // Vérifier si le code existe déjà
+        for (int i = 0; i < accessCodeCount; i++) {
+          if (accessCodes[i].code == code && accessCodes[i].type == type) {
+            status = 400;
+            result = "{\"error\":\"Ce code existe déjà\"}";
+            return;
+          }
+        }
+        
+        if (schedule > MAX_SCHEDULES || (schedule != 0 && !schedules[schedule].used)) {
+          status = 400;
+          result = "{\"error\":\"Plage horaire inconnue\"}";
+          return;
+        }
+        
+        // Ajouter le code
+        if (!addNewAccessCode(code, type, name, schedule, groups)) {
+          status = 500;
+          result = "{\"error\":\"Erreur lors de l'ajout\"}";
           return;
         }
+        LOG_I("✓ Code added via web: %s (code=%lu, type=%d)", name, code, type);
+      })) return;
+      
+      request->send(status, "application/json", result);
+    }
+  );
+  
+  // API - Associer une plage horaire à un code ({"code":..,"type":..,"schedule":id})
+  onJsonBody(server, "/api/codes/schedule", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      if (!doc["code"].is<uint32_t>() || !doc["type"].is<uint8_t>() || !doc["schedule"].is<uint8_t>()) {
+        request->send(400, "application/json", "{\"error\":\"Champs manquants ou invalides\"}");
+        return;
       }
       
-      // Ajouter le code
-      accessCodes[accessCodeCount].code = code;
-      accessCodes[accessCodeCount].type = type;
-      strlcpy(accessCodes[accessCodeCount].name, name, 32);
-      accessCodes[accessCodeCount].active = true;
+      bool assigned = false;
+      if (!runInLoop(request, [&]{
+        assigned = setAccessCodeSchedule(doc["code"], doc["type"], doc["schedule"]);
+      })) return;
       
-      accessCodeCount++;
-      saveAccessCodes();
+      if (assigned) {
+        request->send(200, "application/json", "{\"message\":\"Plage horaire associée\"}");
+      } else {
+        request->send(400, "application/json", "{\"error\":\"Code ou plage introuvable\"}");
+      }
+    }
+  );
+  
+  // API - Groupes d'un code ({"code":..,"type":..,"groups":bitset})
+  onJsonBody(server, "/api/codes/groups", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      if (!doc["code"].is<uint32_t>() || !doc["type"].is<uint8_t>() || !doc["groups"].is<uint16_t>()) {
+        request->send(400, "application/json", "{\"error\":\"Champs manquants ou invalides\"}");
+        return;
+      }
+      
+      bool assigned = false;
+      if (!runInLoop(request, [&]{
+        assigned = setAccessCodeGroups(doc["code"], doc["type"], doc["groups"]);
+      })) return;
+      
+      if (assigned) {
+        request->send(200, "application/json", "{\"message\":\"Groupes associés\"}");
+      } else {
+        request->send(400, "application/json", "{\"error\":\"Code introuvable\"}");
+      }
+    }
+  );
+  
+  // API - Groupes : état, noms et nombre de membres
+  server.on("/api/groups", HTTP_GET, [](AsyncWebServerRequest *request){
+    String response;
+    if (!runInLoop(request, [&]{
+      JsonDocument doc;
+      groupsToJson(doc.to<JsonObject>());  // Membres comptés dans la table
+      serializeJson(doc, response);
+    })) return;
+    request->send(200, "application/json", response);
+  });
+  
+  // Activer/révoquer/renommer : {"id":2,"enabled":false,"name":"Livreurs"}
+  onJsonBody(server, "/api/groups", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      const char* error = nullptr;
+      if (updateGroup(doc, error)) {
+        request->send(200, "application/json", "{\"message\":\"Groupe mis à jour\"}");
+      } else {
+        sendError(request, 400, error);
+      }
+    }
+  );
+  
+  // API - Statistiques d'accès : /api/stats?code=&type= pour un identifiant
+  server.on("/api/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+    JsonDocument doc(&psramJsonAllocator);
+    if (request->hasParam("code")) {
+      // Type obligatoire : le même numéro peut être un PIN, un badge et une empreinte
+      const String& typeText = request->hasParam("type") ? request->getParam("type")->value() : String();
+      if (typeText.length() != 1 || typeText[0] < '0' || typeText[0] > '2') {
+        request->send(400, "application/json", "{\"error\":\"Type manquant ou invalide (0-2)\"}");
+        return;
+      }
+      uint32_t code = strtoul(request->getParam("code")->value().c_str(), nullptr, 10);
+      uint8_t type = typeText[0] - '0';
+      const CodeStats* usage = statsForCode(code, type);
+      doc["code"] = code;
+      doc["type"] = type;
+      doc["uses"] = usage ? usage->uses : 0;
+      doc["denies"] = usage ? usage->denies : 0;
+      doc["lastSeen"] = usage ? usage->lastSeen : 0;
+    } else {
+      statsToJson(doc.to<JsonObject>());
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  server.on("/api/stats/reset", HTTP_POST, [](AsyncWebServerRequest *request){
+    resetStats();
+    request->send(200, "application/json", "{\"success\":true}");
+  });
+  
+  // API - Apprentissage par lot : {"type":1,"name":"Badge {n}","count":50,"timeout":600,"start":1}
+  server.on("/api/learn", HTTP_GET, [](AsyncWebServerRequest *request){
+    JsonDocument doc;
+    doc["learning"] = learningMode;
+    if (learningMode) {
+      doc["batch"] = learningBatch;
+      doc["type"] = learningType;
+      doc["enrolled"] = learningEnrolled;
+      doc["target"] = learningTarget;
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  onJsonBody(server, "/api/learn/batch", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      uint32_t timeoutSec = doc["timeout"] | 0;
+      bool started = false;
+      // Session précédente close (et écrite en flash) par loop()
+      if (doc["type"].is<uint8_t>() && doc["name"].is<const char*>() && !runInLoop(request, [&]{
+            started = startBatchLearning(doc["type"], doc["name"], doc["count"] | 0,
+                                         timeoutSec * 1000UL, doc["start"] | 1);
+          })) return;
+      if (!started) {
+        request->send(400, "application/json", "{\"error\":\"Paramètres invalides (type 1-2, count 0-1000)\"}");
+        return;
+      }
+      request->send(200, "application/json", "{\"message\":\"Apprentissage par lot démarré\"}");
+    }
+  );
+  
+  server.on("/api/learn/stop", HTTP_POST, [](AsyncWebServerRequest *request){
+    if (!runInLoop(request, stopLearningMode)) return;
+    request->send(200, "application/json", "{\"message\":\"Apprentissage arrêté\"}");
+  });
+  
+  // API - Lot d'opérations exécuté en une transaction (voir batch.h)
+  onJsonBody(server, "/api/batch", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      int status = 200;
+      String body;
+      if (!runInLoop(request, [&]{
+        JsonDocument response(&psramJsonAllocator);
+        bool ok = runBatch(doc, response.to<JsonObject>());
+        serializeJson(response, body);
+        // 500 : opérations valides mais écriture flash impossible (lot annulé)
+        status = ok ? 200
+                 : (response["committed"] | false) ? 207
+                 : (response["flashError"] | false) ? 500 : 400;
+      })) return;
+      request->send(status, "application/json", body);
+    }, JSON_BODY_MAX_LARGE
+  );
+  
+  // API - Synchronisation de flotte : version, empreinte et seaux
+  server.on("/api/sync", HTTP_GET, [](AsyncWebServerRequest *request){
+    String response;
+    if (!runInLoop(request, [&]{
+      JsonDocument doc;
+      syncStateToJson(doc.to<JsonObject>(), true);
+      serializeJson(doc, response);
+    })) return;
+    request->send(200, "application/json", response);
+  });
+  
+  server.on("/api/sync/bucket", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!request->hasParam("id")) {
+      request->send(400, "application/json", "{\"error\":\"Paramètre id manquant\"}");
+      return;
+    }
+    
+    int bucket = request->getParam("id")->value().toInt();
+    bool valid = false;
+    String response;
+    if (!runInLoop(request, [&]{
+      JsonDocument doc(&psramJsonAllocator);
+      valid = syncBucketToJson(bucket, doc.to<JsonObject>());
+      if (valid) serializeJson(doc, response);
+    })) return;
+    
+    if (!valid) {
+      request->send(400, "application/json", "{\"error\":\"Seau invalide (0-15)\"}");
+      return;
+    }
+    request->send(200, "application/json", response);
+  });
+  
+  // Delta : {"base":12,"version":13,"remove":[...],"add":[...]}, appliqué en un seul commit
+  onJsonBody(server, "/api/sync/delta", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      const char* error = nullptr;
+      bool applied = false;
+      String body;
+      if (!runInLoop(request, [&]{
+        applied = applyCodeDelta(doc, error);
+        
+        // to<JsonObject>() vide le document : erreur ajoutée après
+        JsonDocument response;
+        syncStateToJson(response.to<JsonObject>(), false);
+        if (!applied) response["error"] = error;
+        serializeJson(response, body);
+      })) return;
+      request->send(applied ? 200 : 409, "application/json", body);
+    }, JSON_BODY_MAX_LARGE
+  );
+  
+  // API - Instantané binaire de l'état (voir snapshot.h)
+  server.on("/api/snapshot", HTTP_GET, [](AsyncWebServerRequest *request){
+    uint16_t sections = requestedSections(request, SNAPSHOT_ALL);
+    if (!sections) {
+      request->send(400, "application/json", "{\"error\":\"Section inconnue\"}");
+      return;
+    }
+    
+    size_t size = 0;
+    uint8_t* data = nullptr;
+    if (!runInLoop(request, [&]{ data = snapshotExport(sections, size); })) return;
+    if (!data) {
+      request->send(503, "application/json", "{\"error\":\"Export impossible\"}");
+      return;
+    }
+    
+    // Tampon libéré avec la réponse, une fois envoyé
+    std::shared_ptr<uint8_t> buffer(data, psramFree);
+    AsyncWebServerResponse* response = request->beginResponse("application/octet-stream", size,
+      [buffer, size](uint8_t* out, size_t maxLen, size_t index) -> size_t {
+        size_t chunk = min(maxLen, size - index);
+        memcpy(out, buffer.get() + index, chunk);
+        return chunk;
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"roller-snapshot.bin\"");
+    request->send(response);
+  });
+  
+  // Restauration : corps binaire validé ici, puis écrit en un seul commit et
+  // les tables rechargées par loop()
+  onBinaryBody(server, "/api/snapshot/restore", HTTP_POST,
+    [](AsyncWebServerRequest *request, const uint8_t* data, size_t size){
+      uint16_t sections = requestedSections(request, SNAPSHOT_ANY);  // Tout ce qui est présent
+      if (!sections) {
+        request->send(400, "application/json", "{\"error\":\"Section inconnue\"}");
+        return;
+      }
       
-      Serial.printf("✓ Code added via web: %s (code=%lu, type=%d)\n", name, code, type);
+      const char* error = nullptr;
+      if (!snapshotCheck(data, size, sections, error)) {
+        sendError(request, 400, error);
+        return;
+      }
       
-      request->send(200, "application/json", "{\"message\":\"Code ajouté\"}");
+      // Corps gardé par le gestionnaire tant qu'il attend loop()
+      bool restored = false;
+      String body;
+      if (!runInLoop(request, [&]{
+        uint16_t applied = 0;
+        restored = snapshotRestore(data, size, sections, applied, error);
+        if (!restored) return;
+        JsonDocument response;
+        response["message"] = "Instantané restauré";
+        snapshotSectionsToJson(applied, response["sections"].to<JsonArray>());
+        response["codes"] = accessCodeCount;
+        response["version"] = codeTableVersion;
+        serializeJson(response, body);
+      })) return;
+      if (!restored) {
+        sendError(request, 500, error);
+        return;
+      }
+      request->send(200, "application/json", body);
+    }, SNAPSHOT_MAX_SIZE
+  );
+  
+  // API - Plages horaires
+  server.on("/api/schedules", HTTP_GET, [](AsyncWebServerRequest *request){
+    JsonDocument doc;
+    uint16_t slot = currentScheduleSlot();
+    doc["timeSynced"] = slot != SCHEDULE_NO_CLOCK;
+    doc["slot"] = slot;
+    JsonArray list = doc["schedules"].to<JsonArray>();
+    
+    for (int id = 1; id <= MAX_SCHEDULES; id++) {
+      if (schedules[id].used) scheduleToJson(id, list.add<JsonObject>());
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  // Créer/remplacer : {"id":1,"name":"Ménage","windows":[{"days":[1,2,3,4,5],"from":"06:00","to":"09:00"}]}
+  onJsonBody(server, "/api/schedules", HTTP_POST,
+    [](AsyncWebServerRequest *request, JsonVariant doc){
+      const char* error = nullptr;
+      if (defineSchedule(doc["id"] | 0, doc, error)) {
+        request->send(200, "application/json", "{\"message\":\"Plage horaire enregistrée\"}");
+      } else {
+        sendError(request, 400, error);
+      }
     }
   );
   
+  server.on("/api/schedules/delete", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!request->hasParam("id")) {
+      request->send(400, "application/json", "{\"error\":\"Paramètre id manquant\"}");
+      return;
+    }
+    
+    const char* error = nullptr;
+    int id = request->getParam("id")->value().toInt();
+    bool deleted = false;
+    if (!runInLoop(request, [&]{ deleted = deleteSchedule(id, error); })) return;  // Codes liés
+    
+    if (deleted) {
+      request->send(200, "application/json", "{\"message\":\"Plage horaire supprimée\"}");
+    } else {
+      sendError(request, 400, error);
+    }
+  });
+  
   // API - Supprimer un code (simple GET avec paramètre)
   server.on("/api/codes/delete", HTTP_GET, [](AsyncWebServerRequest *request){
     if (!request->hasParam("index")) {
@@ -149,8 +703,10 @@ void setupWebServer() {
     }
     
     int idx = request->getParam("index")->value().toInt();
+    bool deleted = false;
+    if (!runInLoop(request, [&]{ deleted = deleteAccessCode(idx); })) return;
     
-    if (deleteAccessCode(idx)) {
+    if (deleted) {
       request->send(200, "application/json", "{\"message\":\"Code supprimé\"}");
     } else {
       request->send(400, "application/json", "{\"error\":\"Index invalide ou erreur lors de la suppression\"}");
@@ -159,16 +715,17 @@ void setupWebServer() {
   
   // API - Récupérer les logs
   server.on("/api/logs", HTTP_GET, [](AsyncWebServerRequest *request){
-    JsonDocument doc;
+    JsonDocument doc(&psramJsonAllocator);
     JsonArray logs = doc["logs"].to<JsonArray>();
     
-    for (int i = 0; i < 100; i++) {
+    for (int i = 0; i < accessLogCapacity; i++) {
       if (accessLogs[i].timestamp > 0) {
         JsonObject log = logs.add<JsonObject>();
         log["timestamp"] = accessLogs[i].timestamp;
         log["code"] = accessLogs[i].code;
         log["granted"] = accessLogs[i].granted;
         log["type"] = accessLogs[i].type;
+        log["reader"] = accessLogs[i].reader;
       }
     }
     
@@ -177,6 +734,38 @@ void setupWebServer() {
     request->send(200, "application/json", response);
   });
   
+  // API - Journal de debug (anneau RAM), ?level=0-4 change le niveau runtime
+  server.on("/api/debuglog", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (request->hasParam("level")) {
+      logSetLevel(request->getParam("level")->value().toInt());
+    }
+
+    JsonDocument doc(&psramJsonAllocator);
+    doc["level"] = logRuntimeLevel.load();
+    doc["compiledLevel"] = LOG_LEVEL;
+    doc["dropped"] = logDroppedCount();
+    JsonArray entries = doc["entries"].to<JsonArray>();
+
+    uint32_t head = logHeadIndex();
+    uint32_t first = head > LOG_RING_SIZE ? head - LOG_RING_SIZE : 0;
+    char line[160];
+
+    for (uint32_t i = first; i != head; i++) {
+      LogEntry entry;
+      if (!logReadEntry(i, entry)) continue;
+
+      logFormat(entry, line, sizeof(line));
+      JsonObject e = entries.add<JsonObject>();
+      e["t"] = entry.timestamp;
+      e["lvl"] = String(logLevelChar(entry.level));
+      e["msg"] = line;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
   // API - Récupérer la configuration
   server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request){
     JsonDocument doc;
@@ -186,41 +775,21 @@ void setupWebServer() {
     doc["mqttPort"] = config.mqttPort;
     doc["mqttUser"] = config.mqttUser;
     doc["mqttTopic"] = config.mqttTopic;
+    doc["timezone"] = config.timezone;
+    doc["maxCodes"] = accessCodeCapacity;
+    doc["maxLogs"] = accessLogCapacity;
     
     String response;
     serializeJson(doc, response);
     request->send(200, "application/json", response);
   });
   
-  // API - Enregistrer la configuration
-  server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-      JsonDocument doc;
-      deserializeJson(doc, (const char*)data);
-      
-      config.relayDuration = doc["relayDuration"] | 5000;
-      config.photoBarrierEnabled = doc["photoEnabled"] | true;
-      config.mqttPort = doc["mqttPort"] | 1883;
-      
-      if (doc.containsKey("mqttServer")) 
-        strlcpy(config.mqttServer, doc["mqttServer"], 64);
-      if (doc.containsKey("mqttUser")) 
-        strlcpy(config.mqttUser, doc["mqttUser"], 32);
-      if (doc.containsKey("mqttPassword")) 
-        strlcpy(config.mqttPassword, doc["mqttPassword"], 32);
-      if (doc.containsKey("mqttTopic")) 
-        strlcpy(config.mqttTopic, doc["mqttTopic"], 64);
-      if (doc.containsKey("adminPassword")) 
-        strlcpy(config.adminPassword, doc["adminPassword"], 32);
-      
-      saveConfig();
-      
-      request->send(200, "application/json", "{\"message\":\"Configuration enregistrée\"}");
-    }
-  );
+  // API - Enregistrer la configuration (POST ou PATCH, mise à jour partielle)
+  onJsonBody(server, "/api/config", HTTP_POST, handleConfigBody);
+  onJsonBody(server, "/api/config", HTTP_PATCH, handleConfigBody);
   
   // ElegantOTA pour les mises à jour
-  ElegantOTA.begin(&server);
+  ElegantOTA.begin(&server);  // Identifiants fixés par authPasswordChanged()
   
-  Serial.println("Web server routes configured");
+  LOG_I("Web server routes configured");
 }
@@ -7,7 +7,7 @@
 
 extern AsyncWebServer server;
 extern Config config;
-extern AccessCode accessCodes[];
+extern AccessCode* accessCodes;
 extern int accessCodeCount;
 
 // Page HTML principale
@@ -206,11 +206,20 @@ const char index_html[] PROGMEM = R"rawliteral(
             <!-- TAB CONTROLE -->
             <div id="control" class="tab-content active">
                 <h2>Contrôle Manuel</h2>
+                <div class="form-group">
+                    <label>Porte:</label>
+                    <select id="door-select"></select>
+                </div>
                 <div class="control-panel">
                     <button class="btn btn-open" onclick="controlRelay('open')">⬆️ Ouvrir</button>
                     <button class="btn btn-close" onclick="controlRelay('close')">⬇️ Fermer</button>
                     <button class="btn btn-stop" onclick="controlRelay('stop')">⏹️ Stop</button>
                 </div>
+                <div class="form-group">
+                    <label>Position (% d'ouverture, porte calibrée):</label>
+                    <input type="number" id="door-position" min="0" max="100" value="50">
+                    <button class="btn btn-add" onclick="controlRelay(document.getElementById('door-position').value + '%')">Aller</button>
+                </div>
                 
                 <div class="status-box">
                     <h3>État du Système</h3>
@@ -230,6 +239,10 @@ const char index_html[] PROGMEM = R"rawliteral(
                         <span>Relais:</span>
                         <span id="relay-status">Inactif</span>
                     </div>
+                    <div class="status-item">
+                        <span>Position:</span>
+                        <span id="position-status">...</span>
+                    </div>
                 </div>
             </div>
             
@@ -260,6 +273,16 @@ const char index_html[] PROGMEM = R"rawliteral(
                     <button class="btn-small" onclick="hideAddCodeForm()">Annuler</button>
                 </div>
                 
+                <div class="form-group" style="display:flex; gap:10px; margin-top:20px;">
+                    <input type="text" id="code-search" placeholder="Rechercher un nom..." oninput="searchCodes()">
+                    <select id="code-filter-type" onchange="searchCodes()">
+                        <option value="">Tous les types</option>
+                        <option value="0">Wiegand/Clavier</option>
+                        <option value="1">RFID</option>
+                        <option value="2">Empreinte</option>
+                    </select>
+                </div>
+                
                 <table id="codes-table">
                     <thead>
                         <tr>
@@ -274,6 +297,11 @@ const char index_html[] PROGMEM = R"rawliteral(
                         <tr><td colspan="5">Chargement...</td></tr>
                     </tbody>
                 </table>
+                <div style="display:flex; justify-content:space-between; align-items:center; margin-top:10px;">
+                    <button class="btn-small" onclick="changeCodePage(-1)">◀ Précédent</button>
+                    <span id="codes-page">-</span>
+                    <button class="btn-small" onclick="changeCodePage(1)">Suivant ▶</button>
+                </div>
             </div>
             
             <!-- TAB LOGS -->
@@ -341,6 +369,14 @@ const char index_html[] PROGMEM = R"rawliteral(
                 </div>
                 
                 <button class="btn btn-add" onclick="saveConfig()">💾 Enregistrer Configuration</button>
+                
+                <h3 style="margin-top: 30px;">Sauvegarde</h3>
+                <button class="btn btn-open" onclick="downloadSnapshot()">📥 Exporter l'état</button>
+                <div class="form-group">
+                    <label>Restaurer un instantané:</label>
+                    <input type="file" id="snapshot-file" accept=".bin">
+                </div>
+                <button class="btn btn-stop" onclick="restoreSnapshot()">📤 Restaurer</button>
             </div>
             
             <!-- TAB UPDATE -->
@@ -355,6 +391,40 @@ const char index_html[] PROGMEM = R"rawliteral(
     </div>
 
     <script>
+        // Session : jeton délivré par /api/login, joint à chaque appel /api
+        const nativeFetch = window.fetch.bind(window);
+        let loginPending = null;
+        let loginCancelled = false;
+        
+        function login() {
+            if (loginCancelled) return Promise.resolve();
+            if (!loginPending) {
+                const password = prompt('Mot de passe administrateur');
+                if (password === null) {
+                    loginCancelled = true;
+                    return Promise.resolve();
+                }
+                loginPending = nativeFetch('/api/login', {
+                    method: 'POST',
+                    headers: {'Content-Type': 'application/json'},
+                    body: JSON.stringify({password: password})
+                }).then(r => r.json()).then(data => {
+                    if (data.token) sessionStorage.setItem('token', data.token);
+                    else alert(data.error || 'Mot de passe incorrect');
+                }).finally(() => { loginPending = null; });
+            }
+            return loginPending;
+        }
+        
+        window.fetch = (url, options = {}) => {
+            const send = () => nativeFetch(url, Object.assign({}, options, {
+                headers: Object.assign({}, options.headers, {
+                    'Authorization': 'Bearer ' + (sessionStorage.getItem('token') || '')
+                })
+            }));
+            return send().then(response => response.status === 401 ? login().then(send) : response);
+        };
+        
         function switchTab(tabName) {
             const tabs = document.querySelectorAll('.tab');
             const contents = document.querySelectorAll('.tab-content');
@@ -374,33 +444,88 @@ const char index_html[] PROGMEM = R"rawliteral(
             fetch('/api/relay', {
                 method: 'POST',
                 headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({action: action})
+                body: JSON.stringify({action: action, door: selectedDoor()})
             })
             .then(r => r.json())
             .then(data => {
-                alert(data.message || 'Commande envoyée');
-                document.getElementById('relay-status').textContent = action === 'stop' ? 'Inactif' : action;
+                alert(data.message || data.error || 'Commande envoyée');
             });
         }
         
+        function selectedDoor() {
+            return parseInt(document.getElementById('door-select').value || '0');
+        }
+        
+        function loadDoors() {
+            fetch('/api/doors')
+            .then(r => r.json())
+            .then(data => {
+                const select = document.getElementById('door-select');
+                if (select.options.length !== data.doors.length) {
+                    select.innerHTML = data.doors.map(d => `<option value="${d.door}">${d.name}</option>`).join('');
+                }
+                const door = data.doors[selectedDoor()];
+                if (door) {
+                    document.getElementById('relay-status').textContent =
+                        door.state === 'idle' ? 'Inactif' : door.direction;
+                    document.getElementById('position-status').textContent =
+                        door.position === null ? 'Inconnue' : door.position + ' %';
+                    if (door.barrier !== undefined) {
+                        document.getElementById('barrier-status').textContent = door.barrier ? 'OK' : 'Coupée';
+                    }
+                }
+            });
+        }
+        
+        // Liste paginée : seule la page affichée est demandée à l'ESP32
+        const CODES_PAGE_SIZE = 50;
+        let codesOffset = 0;
+        let codesTotal = 0;
+        let searchTimer = null;
+        
+        function searchCodes() {
+            clearTimeout(searchTimer);
+            searchTimer = setTimeout(() => { codesOffset = 0; loadCodes(); }, 300);
+        }
+        
+        function changeCodePage(direction) {
+            const next = codesOffset + direction * CODES_PAGE_SIZE;
+            if (next < 0 || next >= codesTotal) return;
+            codesOffset = next;
+            loadCodes();
+        }
+        
         function loadCodes() {
-            fetch('/api/codes')
+            const params = new URLSearchParams({offset: codesOffset, limit: CODES_PAGE_SIZE});
+            const q = document.getElementById('code-search').value.trim();
+            const type = document.getElementById('code-filter-type').value;
+            if (q) params.set('q', q);
+            if (type) params.set('type', type);
+            
+            fetch('/api/codes?' + params)
             .then(r => r.json())
             .then(data => {
-                const tbody = document.getElementById('codes-tbody');
-                tbody.innerHTML = '';
-                data.codes.forEach((code, idx) => {
-                    const types = ['Wiegand', 'RFID', 'Empreinte'];
-                    tbody.innerHTML += `
+                codesTotal = data.total;
+                if (data.codes.length === 0 && codesOffset > 0) {
+                    codesOffset = Math.max(0, codesOffset - CODES_PAGE_SIZE);
+                    return loadCodes();
+                }
+                const types = ['Wiegand', 'RFID', 'Empreinte'];
+                const rows = data.codes.map(code => `
                         <tr>
                             <td>${code.code}</td>
                             <td>${types[code.type]}</td>
                             <td>${code.name}</td>
                             <td><span class="badge badge-success">${code.active ? 'Actif' : 'Inactif'}</span></td>
-                            <td><button class="btn-small btn-delete" onclick="deleteCode(${idx})">Supprimer</button></td>
+                            <td><button class="btn-small btn-delete" onclick="deleteCode(${code.index})">Supprimer</button></td>
                         </tr>
-                    `;
-                });
+                    `);
+                document.getElementById('codes-tbody').innerHTML =
+                    rows.length ? rows.join('') : '<tr><td colspan="5">Aucun code</td></tr>';
+                
+                const last = Math.min(codesOffset + data.codes.length, data.total);
+                document.getElementById('codes-page').textContent =
+                    data.total ? `${codesOffset + 1}-${last} sur ${data.total}` : '0 sur 0';
             });
         }
         
@@ -446,10 +571,13 @@ const char index_html[] PROGMEM = R"rawliteral(
                 mqttServer: document.getElementById('mqtt-server').value,
                 mqttPort: parseInt(document.getElementById('mqtt-port').value),
                 mqttUser: document.getElementById('mqtt-user').value,
-                mqttPassword: document.getElementById('mqtt-password').value,
-                mqttTopic: document.getElementById('mqtt-topic').value,
-                adminPassword: document.getElementById('admin-password').value
+                mqttTopic: document.getElementById('mqtt-topic').value
             };
+            // Mots de passe laissés vides = inchangés
+            const mqttPassword = document.getElementById('mqtt-password').value;
+            const adminPassword = document.getElementById('admin-password').value;
+            if (mqttPassword) config.mqttPassword = mqttPassword;
+            if (adminPassword) config.adminPassword = adminPassword;
             
             fetch('/api/config', {
                 method: 'POST',
@@ -460,6 +588,35 @@ const char index_html[] PROGMEM = R"rawliteral(
             .then(data => alert(data.message || 'Configuration enregistrée'));
         }
         
+        function downloadSnapshot() {
+            fetch('/api/snapshot')
+            .then(r => r.blob())
+            .then(blob => {
+                const link = document.createElement('a');
+                link.href = URL.createObjectURL(blob);
+                link.download = 'roller-snapshot.bin';
+                link.click();
+                URL.revokeObjectURL(link.href);
+            });
+        }
+        
+        function restoreSnapshot() {
+            const file = document.getElementById('snapshot-file').files[0];
+            if (!file || !confirm('Remplacer tout l\'état de l\'appareil ?')) return;
+            
+            fetch('/api/snapshot/restore', {
+                method: 'POST',
+                headers: {'Content-Type': 'application/octet-stream'},
+                body: file
+            })
+            .then(r => r.json())
+            .then(data => {
+                alert(data.message || data.error);
+                loadConfig();
+                loadCodes();
+            });
+        }
+        
         function showAddCodeForm() {
             document.getElementById('add-code-form').style.display = 'block';
         }
@@ -538,11 +695,12 @@ const char index_html[] PROGMEM = R"rawliteral(
         
         // Charger les données au démarrage
         loadCodes();
+        loadDoors();
         setInterval(() => {
             fetch('/api/status').then(r => r.json()).then(data => {
                 document.getElementById('mqtt-status').textContent = data.mqtt ? 'Connecté' : 'Déconnecté';
-                document.getElementById('barrier-status').textContent = data.barrier ? 'OK' : 'Coupée';
             });
+            loadDoors();
         }, 2000);
     </script>
 </body>
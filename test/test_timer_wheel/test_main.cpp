@@ -0,0 +1,144 @@
+#include <unity.h>
+#include "timer_wheel.h"
+
+// Tests natifs de la roue de temporisation (pio test -e native), avec une
+// horloge simulée en ticks de SCHEDULER_TICK_MS
+static uint32_t fakeTick = 0;
+
+static uint32_t fakeNow() {
+  return fakeTick;
+}
+
+static uint32_t bit(TimerId id) {
+  return 1u << id;
+}
+
+// Avance l'horloge tick par tick, comme loop() réveillée à chaque tick
+static uint32_t stepTicks(uint32_t ticks) {
+  uint32_t fired = 0;
+  for (uint32_t i = 0; i < ticks; i++) {
+    fakeTick++;
+    fired |= timerWheelAdvance();
+  }
+  return fired;
+}
+
+void setUp() {
+  fakeTick = 1000;
+  timerWheelBegin(fakeNow);
+}
+
+void tearDown() {}
+
+void test_fires_at_deadline() {
+  timerArm(TIMER_READERS, 50);
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(4));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_READERS), stepTicks(1));
+  TEST_ASSERT_FALSE(timerArmed(TIMER_READERS));
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(300));
+}
+
+void test_delay_rounds_up_to_one_tick() {
+  timerArm(TIMER_DOORS, 0);
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_DOORS), stepTicks(1));
+  timerArm(TIMER_DOORS, 11);
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(1));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_DOORS), stepTicks(1));
+}
+
+void test_rearm_replaces_deadline() {
+  timerArm(TIMER_SWITCHES, 100);
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(5));
+  timerArm(TIMER_SWITCHES, 300);  // Échéance repoussée à +30 ticks
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(29));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_SWITCHES), stepTicks(1));
+
+  timerArm(TIMER_SWITCHES, 2000);
+  timerArm(TIMER_SWITCHES, 20);   // Échéance avancée
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_SWITCHES), stepTicks(2));
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(300));
+}
+
+void test_cancel() {
+  timerArm(TIMER_MQTT, 100);
+  timerCancel(TIMER_MQTT);
+  TEST_ASSERT_FALSE(timerArmed(TIMER_MQTT));
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(300));
+  TEST_ASSERT_EQUAL_UINT32(SCHEDULER_HOUSEKEEPING_MS, timerWheelNextDeadlineMs());
+  timerCancel(TIMER_MQTT);  // Sans effet sur un temporisateur désarmé
+  TEST_ASSERT_FALSE(timerArmed(TIMER_MQTT));
+}
+
+void test_expiry_beyond_one_revolution() {
+  // 600 ticks : la case est visitée deux fois avant l'échéance
+  timerArm(TIMER_RESET_WINDOW, 6000);
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(599));
+  TEST_ASSERT_TRUE(timerArmed(TIMER_RESET_WINDOW));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_RESET_WINDOW), stepTicks(1));
+}
+
+void test_long_stall_fires_everything_due() {
+  timerArm(TIMER_READERS, 30);
+  timerArm(TIMER_DOORS, 2000);
+  timerArm(TIMER_MQTT, 9000);
+  fakeTick += 500;  // loop() bloquée 5 s : plus d'un tour de roue
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_READERS) | bit(TIMER_DOORS), timerWheelAdvance());
+  TEST_ASSERT_TRUE(timerArmed(TIMER_MQTT));
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(399));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_MQTT), stepTicks(1));
+}
+
+void test_tick_wraparound() {
+  fakeTick = 0xFFFFFFF0;
+  timerWheelBegin(fakeNow);
+  timerArm(TIMER_READERS, 300);   // Échéance après le débordement
+  timerArm(TIMER_DOORS, 100);     // Échéance avant
+  TEST_ASSERT_EQUAL_UINT32(100, timerWheelNextDeadlineMs());
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(9));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_DOORS), stepTicks(1));
+  TEST_ASSERT_EQUAL_UINT32(200, timerWheelNextDeadlineMs());
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(19));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_READERS), stepTicks(1));
+  TEST_ASSERT_EQUAL_UINT32(0x0E, fakeTick);
+}
+
+void test_several_timers_in_one_slot() {
+  // Même case : +10 ticks, et +266 ticks (un tour plus loin)
+  timerArm(TIMER_READERS, 100);
+  timerArm(TIMER_SWITCHES, 100);
+  timerArm(TIMER_DOORS, 100);
+  timerArm(TIMER_MQTT, 2660);
+  timerCancel(TIMER_SWITCHES);    // Retrait au milieu de la chaîne
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(9));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_READERS) | bit(TIMER_DOORS), stepTicks(1));
+  TEST_ASSERT_TRUE(timerArmed(TIMER_MQTT));
+
+  timerArm(TIMER_DOORS, 2560);    // Rejoint TIMER_MQTT dans sa case
+  TEST_ASSERT_EQUAL_UINT32(0, stepTicks(255));
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_DOORS) | bit(TIMER_MQTT), stepTicks(1));
+}
+
+void test_next_deadline() {
+  TEST_ASSERT_EQUAL_UINT32(SCHEDULER_HOUSEKEEPING_MS, timerWheelNextDeadlineMs());
+  timerArm(TIMER_HOUSEKEEPING, SCHEDULER_HOUSEKEEPING_MS);
+  timerArm(TIMER_DOORS, 250);
+  TEST_ASSERT_EQUAL_UINT32(250, timerWheelNextDeadlineMs());
+  fakeTick += 30;                 // Échéance passée, pas encore avancée
+  TEST_ASSERT_EQUAL_UINT32(0, timerWheelNextDeadlineMs());
+  TEST_ASSERT_EQUAL_UINT32(bit(TIMER_DOORS), timerWheelAdvance());
+  TEST_ASSERT_EQUAL_UINT32(SCHEDULER_HOUSEKEEPING_MS - 300, timerWheelNextDeadlineMs());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fires_at_deadline);
+  RUN_TEST(test_delay_rounds_up_to_one_tick);
+  RUN_TEST(test_rearm_replaces_deadline);
+  RUN_TEST(test_cancel);
+  RUN_TEST(test_expiry_beyond_one_revolution);
+  RUN_TEST(test_long_stall_fires_everything_due);
+  RUN_TEST(test_tick_wraparound);
+  RUN_TEST(test_several_timers_in_one_slot);
+  RUN_TEST(test_next_deadline);
+  return UNITY_END();
+}